@@ -42,12 +42,15 @@ class ClangParser::Private
 {
   public:
     enum DetectedLang { Detected_Cpp, Detected_ObjC, Detected_ObjCpp };
-    Private() : tu(0), tokens(0), numTokens(0), cursors(0), 
+    Private() : index(0), tu(0), tokens(0), numTokens(0), cursors(0), 
                 ufs(0), sources(0), numFiles(0), fileMapping(257),
                 detectedLang(Detected_Cpp)
     { fileMapping.setAutoDelete(TRUE); }
+   ~Private() { if (index) clang_disposeIndex(index); }
     int getCurrentTokenLine();
+    void init();
     CXIndex index;
+    QStrList commonArgs; // options that are the same for all translation units
     CXTranslationUnit tu;
     QCString fileName;
     CXToken *tokens;
@@ -62,6 +65,33 @@ class ClangParser::Private
     DetectedLang detectedLang;
 };
 
+/** Creates the index that is shared by all translation units and
+ *  collects the include paths and user options, which are the same
+ *  for each file.
+ */
+void ClangParser::Private::init()
+{
+  static QStrList &includePath = Config_getList("INCLUDE_PATH");
+  static QStrList &clangOptions = Config_getList("CLANG_OPTIONS");
+  index = clang_createIndex(0, 0);
+  // add include paths for input files
+  QDictIterator<void> di(Doxygen::inputPaths);
+  for (di.toFirst();di.current();++di)
+  {
+    commonArgs.append(QCString("-I")+di.currentKey());
+  }
+  // add external include paths
+  for (uint i=0;i<includePath.count();i++)
+  {
+    commonArgs.append(QCString("-I")+includePath.at(i));
+  }
+  // user specified options
+  for (uint i=0;i<clangOptions.count();i++)
+  {
+    commonArgs.append(clangOptions.at(i));
+  }
+}
+
 static QCString detab(const QCString &s)
 {
   static int tabSize = Config_getInt("TAB_SIZE");
@@ -158,34 +188,19 @@ void ClangParser::determineInputFilesInSameTu(QStrList &files)
 void ClangParser::start(const char *fileName,QStrList &filesInTranslationUnit)
 {
   static bool clangAssistedParsing = Config_getBool("CLANG_ASSISTED_PARSING");
-  static QStrList &includePath = Config_getList("INCLUDE_PATH");
-  static QStrList clangOptions = Config_getList("CLANG_OPTIONS");
   if (!clangAssistedParsing) return;
   //printf("ClangParser::start(%s)\n",fileName);
+  if (p->index==0) p->init();
   p->fileName = fileName;
-  p->index    = clang_createIndex(0, 0);
   p->curLine  = 1;
   p->curToken = 0;
-  char **argv = (char**)malloc(sizeof(char*)*(4+Doxygen::inputPaths.count()+includePath.count()+clangOptions.count()));
-  QDictIterator<void> di(Doxygen::inputPaths);
+  char **argv = (char**)malloc(sizeof(char*)*(4+p->commonArgs.count()));
   int argc=0;
-  // add include paths for input files
-  for (di.toFirst();di.current();++di,++argc)
-  {
-    QCString inc = QCString("-I")+di.currentKey();
-    argv[argc]=strdup(inc.data());
-    //printf("argv[%d]=%s\n",argc,argv[argc]);
-  }
-  // add external include paths
-  for (uint i=0;i<includePath.count();i++)
-  {
-    QCString inc = QCString("-I")+includePath.at(i);
-    argv[argc++]=strdup(inc.data());
-  }
-  // user specified options
-  for (uint i=0;i<clangOptions.count();i++)
+  // include paths and user specified options
+  QStrListIterator ai(p->commonArgs);
+  for (ai.toFirst();ai.current();++ai)
   {
-    argv[argc++]=strdup(clangOptions.at(i));
+    argv[argc++]=strdup(ai.current());
   }
   // extra options
   argv[argc++]=strdup("-ferror-limit=0");
@@ -347,7 +362,6 @@ void ClangParser::finish()
     delete[] p->cursors;
     clang_disposeTokens(p->tu,p->tokens,p->numTokens);
     clang_disposeTranslationUnit(p->tu);
-    clang_disposeIndex(p->index);
     p->fileMapping.clear();
     p->tokens    = 0;
     p->numTokens = 0;
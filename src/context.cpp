@@ -33,7 +33,9 @@
 #include "filename.h"
 #include "dirdef.h"
 #include "docparser.h"
+#include "doccache.h"
 #include "htmlgen.h"
+#include "outputgen.h"
 #include "htmldocvisitor.h"
 #include "latexgen.h"
 #include "latexdocvisitor.h"
@@ -242,7 +244,8 @@ class PropertyMapper
     };
 
   public:
-    PropertyMapper() : m_map(63) { m_map.setAutoDelete(TRUE); }
+    // some objects have more than 100 properties, keep the hash chains short
+    PropertyMapper() : m_map(257) { m_map.setAutoDelete(TRUE); }
 
     /** Add a property to the map
      *  @param[in] name   The name of the property to add.
@@ -1228,7 +1231,8 @@ static TemplateVariant parseDoc(Definition *def,const QCString &file,int line,
                                 const QCString &relPath,const QCString &docStr,bool isBrief)
 {
   TemplateVariant result;
-  DocRoot *root = validatingParseDoc(file,line,def,0,docStr,TRUE,FALSE,0,isBrief,FALSE);
+  // the same block is parsed again for each output format
+  DocRoot *root = DocCache::instance()->parse(file,line,def,0,docStr,TRUE,FALSE,0,isBrief,FALSE);
   QGString docs;
   {
     FTextStream ts(&docs);
@@ -1259,7 +1263,7 @@ static TemplateVariant parseDoc(Definition *def,const QCString &file,int line,
     result = "";
   else
     result = TemplateVariant(docs,TRUE);
-  delete root;
+  DocCache::instance()->release(root);
   return result;
 }
 
@@ -10068,6 +10072,16 @@ int RefCountedContext::s_totalCount;
 void generateOutputViaTemplate()
 {
   msg("Generating output via template engine...\n");
+  // the pages are rendered one after another, since the documentation
+  // parser and the output format state in g_globals are not reentrant,
+  // but writing them to disk is done on separate threads.
+  bool startWriter = FALSE;
+  int numThreads = getNumProcThreads();
+  if (numThreads>1 && !OutputFileWriter::isActive())
+  {
+    OutputFileWriter::start(numThreads);
+    startWriter = OutputFileWriter::isActive();
+  }
   {
     TemplateEngine e;
     TemplateContext *ctx = e.createContext();
@@ -10227,6 +10241,10 @@ void generateOutputViaTemplate()
       e.destroyContext(ctx);
     }
   }
+  if (startWriter)
+  {
+    OutputFileWriter::stop();
+  }
 #if DEBUG_REF // should be 0, i.e. all objects are deleted
   printf("==== total ref count %d\n",RefCountedContext::s_totalCount);
 #endif
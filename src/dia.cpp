@@ -20,10 +20,10 @@
 #include "config.h"
 #include "message.h"
 #include "util.h"
+#include "diagramjobs.h"
 
 #include <qdir.h>
-
-static const int maxCmdLine = 40960;
+#include <qfileinfo.h>
 
 void writeDiaGraphFromFile(const char *inFile,const char *outDir,
                            const char *outFile,DiaOutputFormat format)
@@ -32,11 +32,6 @@ void writeDiaGraphFromFile(const char *inFile,const char *outDir,
   absOutFile+=portable_pathSeparator();
   absOutFile+=outFile;
 
-  // chdir to the output dir, so dot can find the font file.
-  QCString oldDir = QDir::currentDirPath().utf8();
-  // go to the html output directory (i.e. path)
-  QDir::setCurrent(outDir);
-  //printf("Going to dir %s\n",QDir::currentDirPath().data());
   QCString diaExe = Config_getString("DIA_PATH")+"dia"+portable_commandExtension();
   QCString diaArgs;
   QCString extension;
@@ -52,37 +47,37 @@ void writeDiaGraphFromFile(const char *inFile,const char *outDir,
     extension=".eps";
   }
 
+  // the same file may be used more than once, it only needs one job
+  if (DiagramJobManager::instance()->isScheduled(absOutFile)) return;
+  // skip running dia if the input did not change since the previous run
+  static bool usePdfLatex = Config_getBool("USE_PDFLATEX");
+  if (!checkAndUpdateMd5Signature(absOutFile,fileSignature(inFile,diaArgs)) &&
+      QFileInfo(absOutFile+extension).exists() &&
+      (format!=DIA_EPS || !usePdfLatex || QFileInfo(absOutFile+".pdf").exists())
+     )
+  {
+    return;
+  }
+  // dia runs in the background, so it works on a copy of the input
+  QCString srcFile = absOutFile+"_src.dia";
+  if (!copyFile(inFile,srcFile))
+  {
+    return;
+  }
+
   diaArgs+=" -e \"";
-  diaArgs+=outFile;
+  diaArgs+=absOutFile;
   diaArgs+=extension+"\"";
 
   diaArgs+=" \"";
-  diaArgs+=inFile;
+  diaArgs+=srcFile;
   diaArgs+="\"";
 
-  int exitCode;
   //printf("*** running: %s %s outDir:%s %s\n",diaExe.data(),diaArgs.data(),outDir,outFile);
-  portable_sysTimerStart();
-  if ((exitCode=portable_system(diaExe,diaArgs,FALSE))!=0)
-  {
-    portable_sysTimerStop();
-    goto error;
-  }
-  portable_sysTimerStop();
-  if ( (format==DIA_EPS) && (Config_getBool("USE_PDFLATEX")) )
-  {
-    QCString epstopdfArgs(maxCmdLine);
-    epstopdfArgs.sprintf("\"%s.eps\" --outfile=\"%s.pdf\"",
-                         outFile,outFile);
-    portable_sysTimerStart();
-    if (portable_system("epstopdf",epstopdfArgs)!=0)
-    {
-      err("Problems running epstopdf. Check your TeX installation!\n");
-    }
-    portable_sysTimerStop();
-  }
-
-error:
-  QDir::setCurrent(oldDir);
+  DiagramJob *job = new DiagramJob(diaExe,diaArgs,FALSE,
+                                   "Problems running dia. Check your installation!");
+  job->addTempFile(srcFile);
+  if (format==DIA_EPS) job->addEpsFile(absOutFile);
+  DiagramJobManager::instance()->addJob(job,absOutFile);
 }
 
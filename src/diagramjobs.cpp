@@ -0,0 +1,200 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include <qdir.h>
+#include <qfileinfo.h>
+
+#include "diagramjobs.h"
+#include "config.h"
+#include "message.h"
+#include "portable.h"
+#include "util.h"
+
+DiagramJob::DiagramJob(const char *exe,const char *args,bool hasConsole,
+                       const char *errorMsg)
+  : m_exe(exe), m_args(args), m_hasConsole(hasConsole), m_errorMsg(errorMsg)
+{
+}
+
+void DiagramJob::run(bool usePdfLatex)
+{
+  QDir thisDir;
+  int exitCode;
+  const char *s;
+  // A job can convert several files, of which only some may fail. The
+  // outputs of a previous run are removed first, so the steps below
+  // can be done for each output that was produced, whatever the exit
+  // code of the tool.
+  for (s=m_epsFiles.first();s;s=m_epsFiles.next())
+  {
+    thisDir.remove(QCString(s)+".eps");
+  }
+  for (s=m_removeOutputs.first();s;s=m_removeOutputs.next())
+  {
+    thisDir.remove(s);
+  }
+  if ((exitCode=portable_system(m_exe,m_args,m_hasConsole))!=0)
+  {
+    err("%s Exit code: %d\n",m_errorMsg.data(),exitCode);
+  }
+  if (usePdfLatex)
+  {
+    for (s=m_epsFiles.first();s;s=m_epsFiles.next())
+    {
+      if (!QFileInfo(QCString(s)+".eps").exists()) continue;
+      QCString epstopdfArgs;
+      epstopdfArgs.sprintf("\"%s.eps\" --outfile=\"%s.pdf\"",s,s);
+      if ((exitCode=portable_system("epstopdf",epstopdfArgs))!=0)
+      {
+        err("Problems running epstopdf. Check your TeX installation! Exit code: %d\n",exitCode);
+      }
+    }
+  }
+  const char *output;
+  for (s=m_removeFiles.first(),output=m_removeOutputs.first();
+       s && output;
+       s=m_removeFiles.next(),output=m_removeOutputs.next())
+  {
+    if (QFileInfo(output).exists()) thisDir.remove(s);
+  }
+  for (s=m_tempFiles.first();s;s=m_tempFiles.next())
+  {
+    thisDir.remove(s);
+  }
+}
+
+//--------------------------------------------------------------------
+
+void DiagramJobQueue::enqueue(DiagramJob *job)
+{
+  QMutexLocker locker(&m_mutex);
+  m_queue.enqueue(job);
+  m_bufferNotEmpty.wakeAll();
+}
+
+DiagramJob *DiagramJobQueue::dequeue()
+{
+  QMutexLocker locker(&m_mutex);
+  while (m_queue.isEmpty())
+  {
+    // wait until something is added to the queue
+    m_bufferNotEmpty.wait(&m_mutex);
+  }
+  return m_queue.dequeue();
+}
+
+//--------------------------------------------------------------------
+
+void DiagramWorkerThread::run()
+{
+  DiagramJob *job;
+  while ((job=m_queue->dequeue()))
+  {
+    job->run(m_usePdfLatex);
+  }
+}
+
+//--------------------------------------------------------------------
+
+DiagramJobManager *DiagramJobManager::m_theInstance = 0;
+
+DiagramJobManager *DiagramJobManager::instance()
+{
+  if (!m_theInstance)
+  {
+    m_theInstance = new DiagramJobManager;
+  }
+  return m_theInstance;
+}
+
+DiagramJobManager::DiagramJobManager() : m_outFiles(1009), m_queue(0)
+{
+  m_jobs.setAutoDelete(TRUE);
+  m_workers.setAutoDelete(TRUE);
+  m_numThreads = getNumProcThreads();
+  m_usePdfLatex = Config_getBool("USE_PDFLATEX");
+}
+
+DiagramJobManager::~DiagramJobManager()
+{
+  delete m_queue;
+}
+
+void DiagramJobManager::startWorkers()
+{
+  m_queue = new DiagramJobQueue;
+  int i;
+  for (i=0;i<m_numThreads;i++)
+  {
+    DiagramWorkerThread *thread = new DiagramWorkerThread(m_queue,m_usePdfLatex);
+    thread->start();
+    if (thread->isRunning())
+    {
+      m_workers.append(thread);
+    }
+    else // no more threads available!
+    {
+      delete thread;
+    }
+  }
+}
+
+void DiagramJobManager::addJob(DiagramJob *job,const char *outFile)
+{
+  if (outFile) m_outFiles.insert(outFile,(void*)0x8);
+  m_jobs.append(job);
+  if (m_numThreads>1)
+  {
+    if (m_queue==0) startWorkers();
+    if (m_workers.count()>0) // start the job right away
+    {
+      m_queue->enqueue(job);
+    }
+  }
+}
+
+void DiagramJobManager::run()
+{
+  if (m_jobs.isEmpty()) return;
+  portable_sysTimerStart();
+  if (m_workers.count()>0)
+  {
+    // signal the workers we are done and wait for them to finish
+    QListIterator<DiagramWorkerThread> wli(m_workers);
+    DiagramWorkerThread *thread;
+    for (wli.toFirst();(thread=wli.current());++wli)
+    {
+      m_queue->enqueue(0); // add terminator for each worker
+    }
+    for (wli.toFirst();(thread=wli.current());++wli)
+    {
+      thread->wait();
+    }
+    m_workers.clear();
+    delete m_queue;
+    m_queue=0;
+  }
+  else // no threads to work with
+  {
+    QListIterator<DiagramJob> li(m_jobs);
+    DiagramJob *job;
+    for (li.toFirst();(job=li.current());++li)
+    {
+      job->run(m_usePdfLatex);
+    }
+  }
+  portable_sysTimerStop();
+  m_jobs.clear();
+}
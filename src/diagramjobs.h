@@ -0,0 +1,120 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef DIAGRAMJOBS_H
+#define DIAGRAMJOBS_H
+
+#include <qlist.h>
+#include <qdict.h>
+#include <qstrlist.h>
+#include <qqueue.h>
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+
+/** A run of an external tool that converts diagram sources into images */
+class DiagramJob
+{
+  public:
+    /** Creates a job that runs \a exe with arguments \a args.
+     *  If the tool fails, \a errorMsg is reported together with the exit code.
+     */
+    DiagramJob(const char *exe,const char *args,bool hasConsole,const char *errorMsg);
+    void setArgs(const char *args) { m_args = args; }
+    /** Adds an EPS file (without extension) that is converted to PDF
+     *  after running the tool, when USE_PDFLATEX is enabled and the tool
+     *  produced the file.
+     */
+    void addEpsFile(const char *baseName) { m_epsFiles.append(baseName); }
+    /** Adds a file that is removed after running the tool, if the tool
+     *  produced \a outputFile from it.
+     */
+    void addRemoveFile(const char *fileName,const char *outputFile)
+    { m_removeFiles.append(fileName); m_removeOutputs.append(outputFile); }
+    /** Adds a file that is removed after running the tool */
+    void addTempFile(const char *fileName) { m_tempFiles.append(fileName); }
+    void run(bool usePdfLatex);
+
+  private:
+    QCString m_exe;
+    QCString m_args;
+    bool     m_hasConsole;
+    QCString m_errorMsg;
+    QStrList m_epsFiles;
+    QStrList m_removeFiles;
+    QStrList m_removeOutputs;
+    QStrList m_tempFiles;
+};
+
+/** Queue of diagram jobs shared by the DiagramWorkerThread objects */
+class DiagramJobQueue
+{
+  public:
+    void enqueue(DiagramJob *job);
+    DiagramJob *dequeue();
+  private:
+    QWaitCondition    m_bufferNotEmpty;
+    QQueue<DiagramJob> m_queue;
+    QMutex            m_mutex;
+};
+
+/** Worker thread running diagram jobs */
+class DiagramWorkerThread : public QThread
+{
+  public:
+    DiagramWorkerThread(DiagramJobQueue *queue,bool usePdfLatex)
+      : m_queue(queue), m_usePdfLatex(usePdfLatex) {}
+    void run();
+  private:
+    DiagramJobQueue *m_queue;
+    bool             m_usePdfLatex;
+};
+
+/** Singleton that runs the external tools for PlantUML, mscgen and dia
+ *  diagrams. When more than one thread is available the jobs are
+ *  started as soon as they are added, while doxygen continues
+ *  generating the output.
+ */
+class DiagramJobManager
+{
+  public:
+    static DiagramJobManager *instance();
+    /** Adds a job, the manager takes ownership. If \a outFile is given,
+     *  it is the base name of the image produced by the job.
+     */
+    void addJob(DiagramJob *job,const char *outFile=0);
+    /** Returns TRUE if a job producing image \a outFile was already added.
+     *  Such a job should not be added again, as the jobs would share
+     *  their temporary files.
+     */
+    bool isScheduled(const char *outFile) const { return m_outFiles.find(outFile)!=0; }
+    /** Runs the remaining jobs and waits until all jobs are finished */
+    void run();
+
+  private:
+    DiagramJobManager();
+   ~DiagramJobManager();
+    void startWorkers();
+
+    static DiagramJobManager   *m_theInstance;
+    QList<DiagramJob>           m_jobs;
+    QDict<void>                 m_outFiles;
+    DiagramJobQueue            *m_queue;
+    QList<DiagramWorkerThread>  m_workers;
+    int                         m_numThreads;
+    bool                        m_usePdfLatex;
+};
+
+#endif
@@ -35,6 +35,7 @@
 #include "version.h"
 #include "docbookvisitor.h"
 #include "docparser.h"
+#include "doccache.h"
 #include "language.h"
 #include "parserintf.h"
 #include "arguments.h"
@@ -334,7 +335,7 @@ static void writeDocbookDocBlock(FTextStream &t,
   QCString stext = text.stripWhiteSpace();
   if (stext.isEmpty()) return;
   // convert the documentation string into an abstract syntax tree
-  DocNode *root = validatingParseDoc(fileName,lineNr,scope,md,text,FALSE,FALSE);
+  DocRoot *root = DocCache::instance()->parse(fileName,lineNr,scope,md,text,FALSE,FALSE);
   // create a code generator
   DocbookCodeGenerator *docbookCodeGen = new DocbookCodeGenerator(t);
   // create a parse tree visitor for Docbook
@@ -344,7 +345,7 @@ static void writeDocbookDocBlock(FTextStream &t,
   // clean up
   delete visitor;
   delete docbookCodeGen;
-  delete root;
+  DocCache::instance()->release(root);
 }
 
 void writeDocbookCodeBlock(FTextStream &t,FileDef *fd)
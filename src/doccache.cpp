@@ -0,0 +1,185 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include "doccache.h"
+#include "docparser.h"
+#include "doxygen.h"
+#include "config.h"
+
+/** A cached tree. Entries form a list ordered by the time of last use. */
+struct DocCache::Entry
+{
+  Entry(const QCString &k,DocRoot *r,bool i)
+    : key(k), root(r), indexed(i), useCount(0), prev(0), next(0) {}
+ ~Entry() { delete root; }
+  QCString  key;
+  DocRoot  *root;
+  bool      indexed;  // the words were put in the search index while parsing
+  int       useCount;
+  Entry    *prev;
+  Entry    *next;
+};
+
+DocCache *DocCache::s_instance = 0;
+
+DocCache *DocCache::instance()
+{
+  if (s_instance==0)
+  {
+    s_instance = new DocCache(Config_getInt("DOC_CACHE_SIZE"));
+  }
+  return s_instance;
+}
+
+void DocCache::deleteInstance()
+{
+  delete s_instance;
+  s_instance=0;
+}
+
+DocCache::DocCache(int maxSize) : m_dict(1009), m_roots(1009),
+  m_first(0), m_last(0), m_maxSize(maxSize)
+{
+}
+
+DocCache::~DocCache()
+{
+  Entry *e = m_first;
+  while (e)
+  {
+    Entry *next = e->next;
+    delete e;
+    e = next;
+  }
+}
+
+static QCString rootKey(const DocRoot *root)
+{
+  QCString key;
+  key.sprintf("%p",(const void *)root);
+  return key;
+}
+
+void DocCache::unlink(Entry *e)
+{
+  if (e->prev) e->prev->next = e->next; else m_first = e->next;
+  if (e->next) e->next->prev = e->prev; else m_last  = e->prev;
+  e->prev = e->next = 0;
+}
+
+void DocCache::prepend(Entry *e)
+{
+  e->prev = 0;
+  e->next = m_first;
+  if (m_first) m_first->prev = e; else m_last = e;
+  m_first = e;
+}
+
+void DocCache::evict()
+{
+  Entry *e = m_last;
+  while (e && (int)m_dict.count()>m_maxSize)
+  {
+    Entry *prev = e->prev;
+    if (e->useCount==0)
+    {
+      unlink(e);
+      m_dict.remove(e->key);
+      m_roots.remove(rootKey(e->root));
+      delete e;
+    }
+    e = prev;
+  }
+}
+
+DocRoot *DocCache::parse(const char *fileName,int startLine,
+                         Definition *ctx,MemberDef *md,
+                         const char *input,bool indexWords,
+                         bool isExample,const char *exampleName,
+                         bool singleLine,bool linkFromIndex)
+{
+  if (m_maxSize==0)
+  {
+    return validatingParseDoc(fileName,startLine,ctx,md,input,indexWords,
+                              isExample,exampleName,singleLine,linkFromIndex);
+  }
+
+  // the parser appends a newline to the input if it does not end with one
+  int inputLen = qstrlen(input);
+  bool addNewline = inputLen==0 || input[inputLen-1]!='\n';
+  QCString key;
+  key.sprintf("%p:%p:%d:%d%d%d%d:",(void*)ctx,(void*)md,startLine,
+              isExample,singleLine,linkFromIndex,Doxygen::insideMainPage);
+  key+=fileName;
+  key+='\n';
+  key+=exampleName;
+  key+='\n';
+  key+=input;
+  if (addNewline) key+='\n';
+
+  indexWords = indexWords && Doxygen::searchIndex;
+  Entry *e = m_dict.find(key);
+  if (e && e->useCount>0 && indexWords && !e->indexed)
+  {
+    // the cached tree is in use and its words were not indexed, parse
+    // again to put them in the search index, without caching the result
+    return validatingParseDoc(fileName,startLine,ctx,md,input,indexWords,
+                              isExample,exampleName,singleLine,linkFromIndex);
+  }
+  if (e && indexWords && !e->indexed)
+  {
+    // parse again to put the words in the search index
+    unlink(e);
+    m_dict.remove(key);
+    m_roots.remove(rootKey(e->root));
+    delete e;
+    e=0;
+  }
+  if (e==0)
+  {
+    DocRoot *root = validatingParseDoc(fileName,startLine,ctx,md,input,indexWords,
+                                       isExample,exampleName,singleLine,linkFromIndex);
+    e = new Entry(key,root,indexWords);
+    m_dict.insert(key,e);
+    m_roots.insert(rootKey(root),e);
+  }
+  else
+  {
+    unlink(e);
+  }
+  prepend(e);
+  e->useCount++;
+  evict();
+  return e->root;
+}
+
+void DocCache::release(DocRoot *root)
+{
+  if (m_maxSize==0)
+  {
+    delete root;
+    return;
+  }
+  Entry *e = m_roots.find(rootKey(root));
+  if (e==0) // not cached, see parse()
+  {
+    delete root;
+  }
+  else if (e->useCount>0)
+  {
+    e->useCount--;
+    evict();
+  }
+}
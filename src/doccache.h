@@ -0,0 +1,73 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef DOCCACHE_H
+#define DOCCACHE_H
+
+#include <qcstring.h>
+#include <qdict.h>
+
+class DocRoot;
+class Definition;
+class MemberDef;
+
+/** @brief Cache of parsed documentation blocks.
+ *
+ *  The same documentation block is often parsed more than once, for
+ *  instance by the template engine for each output format, or when a
+ *  brief description is shown on several pages. parse() returns the tree
+ *  of an earlier call with the same arguments if it is still cached.
+ *
+ *  The trees are owned by the cache. A tree returned by parse() stays
+ *  valid until it is handed back via release(); only trees that are not
+ *  in use are discarded when the cache is full, the least recently used
+ *  one first.
+ */
+class DocCache
+{
+  public:
+    static DocCache *instance();
+    static void deleteInstance();
+
+    /** Returns the tree for a documentation block, see validatingParseDoc()
+     *  for the meaning of the arguments. A cached tree is only returned
+     *  for \a indexWords if its words were put in the search index.
+     */
+    DocRoot *parse(const char *fileName,int startLine,
+                   Definition *ctx,MemberDef *md,
+                   const char *input,bool indexWords,
+                   bool isExample,const char *exampleName=0,
+                   bool singleLine=FALSE,bool linkFromIndex=FALSE);
+
+    /** Hands back a tree returned by parse(). */
+    void release(DocRoot *root);
+
+  private:
+    struct Entry;
+    DocCache(int maxSize);
+   ~DocCache();
+    void unlink(Entry *e);
+    void prepend(Entry *e);
+    void evict();
+
+    static DocCache *s_instance;
+    QDict<Entry>  m_dict;    // key -> entry
+    QDict<Entry>  m_roots;   // tree address -> entry, for release()
+    Entry        *m_first;   // most recently used
+    Entry        *m_last;    // least recently used
+    int           m_maxSize;
+};
+
+#endif
@@ -82,6 +82,61 @@ static const char *sectionLevelToName[] =
 
 //---------------------------------------------------------------------------
 
+// Nodes are small and created and destroyed in very large numbers, so they
+// are carved from larger blocks, with a free list for each slot size.
+#define DOCNODE_SLOT_ALIGN     8
+#define DOCNODE_MAX_SLOT_SIZE  256
+#define DOCNODE_BLOCK_SIZE     65536
+
+struct DocNodeFreeSlot
+{
+  DocNodeFreeSlot *next;
+};
+
+static DocNodeFreeSlot *g_docNodeFreeSlots[DOCNODE_MAX_SLOT_SIZE/DOCNODE_SLOT_ALIGN];
+
+int DocNode::numAllocated  = 0;
+int DocNode::numPoolBlocks = 0;
+
+void *DocNode::operator new(size_t size)
+{
+  numAllocated++;
+  if (size>DOCNODE_MAX_SLOT_SIZE) return ::operator new(size);
+  int index = (size+DOCNODE_SLOT_ALIGN-1)/DOCNODE_SLOT_ALIGN-1;
+  DocNodeFreeSlot *slot = g_docNodeFreeSlots[index];
+  if (slot==0) // no free slots left, divide a new block
+  {
+    size_t slotSize = (index+1)*DOCNODE_SLOT_ALIGN;
+    char *block = (char *)::operator new(DOCNODE_BLOCK_SIZE);
+    numPoolBlocks++;
+    int i;
+    for (i=DOCNODE_BLOCK_SIZE/slotSize-1;i>=0;i--)
+    {
+      DocNodeFreeSlot *s = (DocNodeFreeSlot *)(block+i*slotSize);
+      s->next = slot;
+      slot = s;
+    }
+  }
+  g_docNodeFreeSlots[index] = slot->next;
+  return slot;
+}
+
+void DocNode::operator delete(void *p,size_t size)
+{
+  if (p==0) return;
+  if (size>DOCNODE_MAX_SLOT_SIZE)
+  {
+    ::operator delete(p);
+    return;
+  }
+  int index = (size+DOCNODE_SLOT_ALIGN-1)/DOCNODE_SLOT_ALIGN-1;
+  DocNodeFreeSlot *s = (DocNodeFreeSlot *)p;
+  s->next = g_docNodeFreeSlots[index];
+  g_docNodeFreeSlots[index] = s;
+}
+
+//---------------------------------------------------------------------------
+
 // Parser state: global variables during a call to validatingParseDoc
 static Definition *           g_scope;
 static QCString               g_context;
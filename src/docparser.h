@@ -157,6 +157,15 @@ class DocNode
     /*! Returns TRUE iff this node is inside a preformatted section */
     bool isPreformatted() const { return m_insidePre; }
 
+    /*! Nodes are taken from a pool of fixed size slots instead of the heap.
+     *  Like the parser itself, this is not thread safe.
+     */
+    static void *operator new(size_t size);
+    static void operator delete(void *p,size_t size);
+
+    static int numAllocated;  //!< number of nodes created so far
+    static int numPoolBlocks; //!< number of memory blocks used by the pool
+
   protected:
     /*! Sets whether or not this item is inside a preformatted section */
     void setInsidePreformatted(bool p) { m_insidePre = p; }
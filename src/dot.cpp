@@ -25,6 +25,11 @@
 #include <qmutex.h>
 #include <qwaitcondition.h>
 
+#include "settings.h"
+#if USE_LIBGVC
+#include <gvc.h>
+#endif
+
 #include "dot.h"
 #include "doxygen.h"
 #include "message.h"
@@ -50,6 +55,9 @@
 
 #define MAP_CMD "cmapx"
 
+// maximum length of the file names passed to a single dot process
+#define MAX_DOT_BATCH_ARGS 8000
+
 //#define FONTNAME "Helvetica"
 #define FONTNAME getDotFontName()
 #define FONTSIZE getDotFontSize()
@@ -723,41 +731,15 @@ static void removeDotGraph(const QCString &dotName)
 
 
 
-/*! Checks if a file "baseName".md5 exists. If so the contents
- *  are compared with \a md5. If equal FALSE is returned. If the .md5
- *  file does not exist or its contents are not equal to \a md5, 
- *  a new .md5 is generated with the \a md5 string as contents.
+/*! Returns TRUE if the files \a file1 and \a file2 produced from the dot
+ *  file of \a baseName exist. If a dot run for the file was already added
+ *  in this run, the files count as missing, as dot may still be writing them.
  */
-static bool checkAndUpdateMd5Signature(const QCString &baseName,
-            const QCString &md5)
-{
-  QFile f(baseName+".md5");
-  if (f.open(IO_ReadOnly))
-  {
-    // read checksum
-    QCString md5stored(33);
-    int bytesRead=f.readBlock(md5stored.rawData(),32);
-    md5stored[32]='\0';
-    // compare checksum
-    if (bytesRead==32 && md5==md5stored)
-    {
-      // bail out if equal
-      return FALSE;
-    }
-  }
-  f.close();
-  // create checksum file
-  if (f.open(IO_WriteOnly))
-  {
-    f.writeBlock(md5.data(),32); 
-    f.close();
-  }
-  return TRUE;
-}
-
-static bool checkDeliverables(const QCString &file1,
+static bool checkDeliverables(const QCString &baseName,
+                              const QCString &file1,
                               const QCString &file2=QCString())
 {
+  if (DotManager::instance()->isScheduled(baseName+".dot")) return FALSE;
   bool file1Ok = TRUE;
   bool file2Ok = TRUE;
   if (!file1.isEmpty())
@@ -773,6 +755,36 @@ static bool checkDeliverables(const QCString &file1,
   return file1Ok && file2Ok;
 }
 
+/*! Returns TRUE if the graphs are rendered in-process with the Graphviz
+ *  library. The library can only lay out one graph at a time, so when
+ *  more than one dot thread is configured, dot processes are used instead.
+ */
+static bool renderInProcess()
+{
+#if USE_LIBGVC
+  static bool inProcess = Config_getInt("DOT_NUM_THREADS")==1;
+  return inProcess;
+#else
+  return FALSE;
+#endif
+}
+
+/*! Writes \a graph to the dot file \a fileName. Returns FALSE if the file
+ *  could not be written. When graphs are rendered in-process, the graph
+ *  is passed to the DotRunner in memory, so the file is only written if
+ *  DOT_CLEANUP is disabled.
+ */
+static bool writeDotFile(const QCString &fileName,const char *graph)
+{
+  static bool dotCleanUp = Config_getBool("DOT_CLEANUP");
+  if (dotCleanUp && renderInProcess()) return TRUE;
+  QFile f(fileName);
+  if (!f.open(IO_WriteOnly)) return FALSE;
+  FTextStream t(&f);
+  t << graph;
+  return TRUE;
+}
+
 //--------------------------------------------------------------------
 
 inline int DotNode::findParent( DotNode *n )
@@ -801,13 +813,74 @@ DotRunner::DotRunner(const QCString &file,const QCString &path,
   static bool dotMultiTargets = Config_getBool("DOT_MULTI_TARGETS");
   m_cleanUp      = dotCleanUp;
   m_multiTargets = dotMultiTargets;
+  m_inProcess    = renderInProcess();
   m_jobs.setAutoDelete(TRUE);
+  m_formats.setAutoDelete(TRUE);
+  m_outputs.setAutoDelete(TRUE);
 }
 
 void DotRunner::addJob(const char *format,const char *output)
 {
   QCString args = QCString("-T")+format+" -o \""+output+"\"";
   m_jobs.append(new DotConstString(args));
+  m_formats.append(new DotConstString(format));
+  m_outputs.append(new DotConstString(output));
+}
+
+#if USE_LIBGVC
+// Graphviz keeps global state in its parser and layout engines,
+// so only one graph can be rendered at a time.
+static QMutex  g_gvcMutex;
+static GVC_t  *g_gvc = 0;
+
+/*! Renders the dot \a graph read from \a fileName using the Graphviz
+ *  library, writing the output with format \a formats[i] to \a outputs[i].
+ */
+static bool renderGraph(const char *fileName,const char *graph,
+                        const QList<DotConstString> &formats,
+                        const QList<DotConstString> &outputs)
+{
+  QMutexLocker locker(&g_gvcMutex);
+  if (g_gvc==0)
+  {
+    g_gvc = gvContext();
+  }
+  Agraph_t *g = agmemread(graph);
+  if (g==0)
+  {
+    err("Problems parsing dot file %s\n",fileName);
+    return FALSE;
+  }
+  bool result=TRUE;
+  if (gvLayout(g_gvc,g,"dot")!=0)
+  {
+    err("Problems laying out dot file %s\n",fileName);
+    result=FALSE;
+  }
+  else
+  {
+    QListIterator<DotConstString> fi(formats);
+    QListIterator<DotConstString> oi(outputs);
+    DotConstString *format,*output;
+    for (;(format=fi.current()) && (output=oi.current());++fi,++oi)
+    {
+      if (gvRenderFilename(g_gvc,g,format->data(),output->data())!=0)
+      {
+        err("Problems rendering dot file %s to %s\n",fileName,output->data());
+        result=FALSE;
+      }
+    }
+    gvFreeLayout(g_gvc,g);
+  }
+  agclose(g);
+  return result;
+}
+#endif
+
+void DotRunner::setGraph(const QCString &graph)
+{
+  // otherwise the graph is read from the dot file by dot itself
+  if (m_inProcess) m_graph.set(graph);
 }
 
 void DotRunner::addPostProcessing(const char *cmd,const char *args)
@@ -818,6 +891,29 @@ void DotRunner::addPostProcessing(const char *cmd,const char *args)
 
 bool DotRunner::run()
 {
+#if USE_LIBGVC
+  if (m_inProcess)
+  {
+    if (m_graph.isEmpty()) // graph was not passed in memory
+    {
+      QFile f(m_file.data());
+      if (!f.open(IO_ReadOnly))
+      {
+        err("Could not open dot file %s\n",m_file.data());
+        return FALSE;
+      }
+      QCString graph(f.size()+1);
+      graph.resize(f.readBlock(graph.rawData(),f.size())+1);
+      m_graph.set(graph);
+    }
+    if (!renderGraph(m_file.data(),m_graph.data(),m_formats,m_outputs))
+    {
+      return FALSE;
+    }
+    m_graph.set(QCString()); // no longer needed
+    return finishRun();
+  }
+#endif
   int exitCode=0;
 
   QCString dotArgs;
@@ -847,6 +943,16 @@ bool DotRunner::run()
       }
     }
   }
+  return finishRun();
+error:
+  err("Problems running dot: exit code=%d, command='%s', arguments='%s'\n",
+      exitCode,m_dotExe.data(),dotArgs.data());
+  return FALSE;
+}
+
+/*! Does the steps that follow running dot for this graph */
+bool DotRunner::finishRun()
+{
   if (!m_postCmd.isEmpty() && portable_system(m_postCmd.data(),m_postArgs.data())!=0)
   {
     err("Problems running '%s' as a post-processing step for dot output\n",m_postCmd.data());
@@ -864,10 +970,110 @@ bool DotRunner::run()
     m_cleanupItem.path.set(m_path.data());
   }
   return TRUE;
-error:
-  err("Problems running dot: exit code=%d, command='%s', arguments='%s'\n",
-      exitCode,m_dotExe.data(),dotArgs.data());
-  return FALSE;
+}
+
+QCString DotRunner::key() const
+{
+  QCString result = m_file.data();
+  QListIterator<DotConstString> li(m_jobs);
+  DotConstString *s;
+  for (;(s=li.current());++li)
+  {
+    result+='\n';
+    result+=s->data();
+  }
+  if (!m_postCmd.isEmpty())
+  {
+    result+=QCString("\n")+m_postCmd.data()+" "+m_postArgs.data();
+  }
+  return result;
+}
+
+bool DotRunner::canBatchWith(const DotRunner *other) const
+{
+  if (!m_postCmd.isEmpty() || !other->m_postCmd.isEmpty()) return FALSE;
+  // dot -O would write both outputs to the same file
+  if (qstrcmp(m_file.data(),other->m_file.data())==0) return FALSE;
+  if (m_formats.count()!=other->m_formats.count()) return FALSE;
+  // a batch produces all formats with one dot call, which is what
+  // DOT_MULTI_TARGETS=NO is meant to avoid
+  if (!m_multiTargets && m_formats.count()>1) return FALSE;
+  QListIterator<DotConstString> li1(m_formats);
+  QListIterator<DotConstString> li2(other->m_formats);
+  DotConstString *f1,*f2;
+  for (;(f1=li1.current()) && (f2=li2.current());++li1,++li2)
+  {
+    if (qstrcmp(f1->data(),f2->data())!=0) return FALSE;
+  }
+  return TRUE;
+}
+
+/*! Returns the extension dot -O adds to the input file name for
+ *  output \a format. For a format like png:cairo:gd this is gd.cairo.png.
+ */
+static QCString autoOutputExtension(const char *format)
+{
+  QCString f = format;
+  QCString result;
+  int i;
+  while ((i=f.findRev(':'))!=-1)
+  {
+    result+=f.mid(i+1)+".";
+    f=f.left(i);
+  }
+  result+=f;
+  return result;
+}
+
+void DotRunner::runBatch(const QList<DotRunner> &runners)
+{
+  QListIterator<DotRunner> li(runners);
+  DotRunner *dr;
+  if (runners.count()>1 && !runners.getFirst()->m_inProcess)
+  {
+    // let dot name the outputs after the input files (-O), so all graphs
+    // can be passed to the same process, and move them in place afterwards
+    DotRunner *first = li.toFirst();
+    QCString dotArgs;
+    QListIterator<DotConstString> fi(first->m_formats);
+    DotConstString *format;
+    for (;(format=fi.current());++fi)
+    {
+      dotArgs+=QCString("-T")+format->data()+" ";
+    }
+    dotArgs+="-O";
+    for (li.toFirst();(dr=li.current());++li)
+    {
+      dotArgs+=QCString(" \"")+dr->m_file.data()+"\"";
+    }
+    if (portable_system(first->m_dotExe.data(),dotArgs,FALSE)==0)
+    {
+      QDir thisDir;
+      for (li.toFirst();(dr=li.current());++li)
+      {
+        QListIterator<DotConstString> fli(dr->m_formats);
+        QListIterator<DotConstString> oli(dr->m_outputs);
+        DotConstString *output;
+        for (;(format=fli.current()) && (output=oli.current());++fli,++oli)
+        {
+          QCString autoName = QCString(dr->m_file.data())+"."+autoOutputExtension(format->data());
+          thisDir.remove(output->data());
+          if (!thisDir.rename(autoName,output->data()))
+          {
+            err("Could not rename %s to %s\n",autoName.data(),output->data());
+          }
+        }
+        dr->finishRun();
+      }
+      return;
+    }
+    // one of the graphs could be broken, run them one by one instead,
+    // so only that graph fails.
+  }
+  for (li.toFirst();(dr=li.current());++li)
+  {
+    dr->run();
+  }
 }
 
 //--------------------------------------------------------------------
@@ -1164,6 +1370,18 @@ void DotRunnerQueue::enqueue(DotRunner *runner)
   m_bufferNotEmpty.wakeAll();
 }
 
+void DotRunnerQueue::enqueueBatch(const QList<DotRunner> &runners)
+{
+  QMutexLocker locker(&m_mutex);
+  QListIterator<DotRunner> li(runners);
+  DotRunner *runner;
+  for (;(runner=li.current());++li)
+  {
+    m_queue.enqueue(runner);
+  }
+  m_bufferNotEmpty.wakeAll();
+}
+
 DotRunner *DotRunnerQueue::dequeue()
 {
   QMutexLocker locker(&m_mutex);
@@ -1176,6 +1394,36 @@ DotRunner *DotRunnerQueue::dequeue()
   return result;
 }
 
+/*! Takes the first runner from the queue plus the runners directly after
+ *  it that can be processed by the same dot invocation, up to \a maxCount
+ *  runners in total. Returns an empty list if a terminator was dequeued.
+ */
+void DotRunnerQueue::dequeueBatch(QList<DotRunner> &runners,uint maxCount)
+{
+  QMutexLocker locker(&m_mutex);
+  while (m_queue.isEmpty())
+  {
+    // wait until something is added to the queue
+    m_bufferNotEmpty.wait(&m_mutex);
+  }
+  DotRunner *first = m_queue.dequeue();
+  if (first==0) return;
+  runners.append(first);
+  uint argLen = qstrlen(first->file());
+  while (runners.count()<maxCount && !m_queue.isEmpty())
+  {
+    DotRunner *next = m_queue.head();
+    // stay well below the command line length limit of the platform
+    if (next==0 || !first->canBatchWith(next) ||
+        argLen+qstrlen(next->file())+3>MAX_DOT_BATCH_ARGS)
+    {
+      break;
+    }
+    argLen+=qstrlen(next->file())+3;
+    runners.append(m_queue.dequeue());
+  }
+}
+
 uint DotRunnerQueue::count() const
 {
   QMutexLocker locker(&m_mutex);
@@ -1184,22 +1432,29 @@ uint DotRunnerQueue::count() const
 
 //--------------------------------------------------------------------
 
-DotWorkerThread::DotWorkerThread(DotRunnerQueue *queue)
-      : m_queue(queue)
+DotWorkerThread::DotWorkerThread(DotRunnerQueue *queue,int batchSize)
+      : m_queue(queue), m_batchSize(batchSize)
 {
   m_cleanupItems.setAutoDelete(TRUE);
 }
 
 void DotWorkerThread::run()
 {
-  DotRunner *runner;
-  while ((runner=m_queue->dequeue()))
+  for (;;)
   {
-    runner->run();
-    const DotRunner::CleanupItem &cleanup = runner->cleanup();
-    if (!cleanup.file.isEmpty())
+    QList<DotRunner> runners;
+    m_queue->dequeueBatch(runners,m_batchSize);
+    if (runners.isEmpty()) break; // terminator
+    DotRunner::runBatch(runners);
+    QListIterator<DotRunner> li(runners);
+    DotRunner *runner;
+    for (;(runner=li.current());++li)
     {
-      m_cleanupItems.append(new DotRunner::CleanupItem(cleanup));
+      const DotRunner::CleanupItem &cleanup = runner->cleanup();
+      if (!cleanup.file.isEmpty())
+      {
+        m_cleanupItems.append(new DotRunner::CleanupItem(cleanup));
+      }
     }
   }
 }
@@ -1227,19 +1482,20 @@ DotManager *DotManager::instance()
   return m_theInstance;
 }
 
-DotManager::DotManager() : m_dotMaps(1009)
+DotManager::DotManager() : m_dotFiles(1009), m_dotRunKeys(1009), m_dotMaps(1009), m_fontPathSet(FALSE)
 {
   m_dotRuns.setAutoDelete(TRUE);
   m_dotMaps.setAutoDelete(TRUE);
   m_queue = new DotRunnerQueue;
   int i;
+  m_batchSize = QMAX(1,Config_getInt("DOT_BATCH_SIZE"));
   int numThreads = QMIN(32,Config_getInt("DOT_NUM_THREADS"));
   if (numThreads!=1)
   {
     if (numThreads==0) numThreads = QMAX(2,QThread::idealThreadCount()+1);
     for (i=0;i<numThreads;i++)
     {
-      DotWorkerThread *thread = new DotWorkerThread(m_queue);
+      DotWorkerThread *thread = new DotWorkerThread(m_queue,m_batchSize);
       thread->start();
       if (thread->isRunning())
       {
@@ -1259,9 +1515,77 @@ DotManager::~DotManager()
   delete m_queue;
 }
 
+static bool setDotFontPathForOutput()
+{
+  if (Config_getBool("GENERATE_HTML"))
+  {
+    setDotFontPath(Config_getString("HTML_OUTPUT"));
+  }
+  else if (Config_getBool("GENERATE_LATEX"))
+  {
+    setDotFontPath(Config_getString("LATEX_OUTPUT"));
+  }
+  else if (Config_getBool("GENERATE_RTF"))
+  {
+    setDotFontPath(Config_getString("RTF_OUTPUT"));
+  }
+  else
+  {
+    return FALSE;
+  }
+  return TRUE;
+}
+
 void DotManager::addRun(DotRunner *run)
 {
+  QCString key = run->key();
+  if (m_dotRunKeys.find(key))
+  {
+    // the same graph is used more than once with the same outputs, and
+    // its dot file is already being processed
+    delete run;
+    return;
+  }
+  // a run for the same dot file with other outputs, for instance for
+  // another output format, is still needed
+  m_dotRunKeys.insert(key,(void*)0x8);
+  m_dotFiles.insert(run->file(),(void*)0x8);
   m_dotRuns.append(run);
+  if (m_workers.count()>0) // start running dot right away
+  {
+    if (!m_fontPathSet)
+    {
+      // the environment must be set before the first dot process is started
+      m_fontPathSet = setDotFontPathForOutput();
+    }
+    if (m_batchSize>1)
+    {
+      // hold the run back until a batch of compatible runs is complete,
+      // otherwise idle workers would take the runs one at a time
+      if (!m_pendingRuns.isEmpty() && !m_pendingRuns.getFirst()->canBatchWith(run))
+      {
+        flushPendingRuns();
+      }
+      m_pendingRuns.append(run);
+      if (m_pendingRuns.count()>=(uint)m_batchSize)
+      {
+        flushPendingRuns();
+      }
+    }
+    else
+    {
+      m_queue->enqueue(run);
+    }
+  }
+}
+
+void DotManager::flushPendingRuns()
+{
+  if (!m_pendingRuns.isEmpty())
+  {
+    m_queue->enqueueBatch(m_pendingRuns);
+    m_pendingRuns.clear();
+  }
 }
 
 int DotManager::addMap(const QCString &file,const QCString &mapFile,
@@ -1332,41 +1656,45 @@ bool DotManager::run()
   int i=1;
   QListIterator<DotRunner> li(m_dotRuns);
 
-  bool setPath=FALSE;
-  if (Config_getBool("GENERATE_HTML"))
+  if (!m_fontPathSet)
   {
-    setDotFontPath(Config_getString("HTML_OUTPUT"));
-    setPath=TRUE;
-  }
-  else if (Config_getBool("GENERATE_LATEX"))
-  {
-    setDotFontPath(Config_getString("LATEX_OUTPUT"));
-    setPath=TRUE;
-  }
-  else if (Config_getBool("GENERATE_RTF"))
-  {
-    setDotFontPath(Config_getString("RTF_OUTPUT"));
-    setPath=TRUE;
+    m_fontPathSet = setDotFontPathForOutput();
   }
   portable_sysTimerStart();
-  // fill work queue with dot operations
   DotRunner *dr;
   int prev=1;
   if (m_workers.count()==0) // no threads to work with
   {
-    for (li.toFirst();(dr=li.current());++li)
+    li.toFirst();
+    while ((dr=li.current()))
     {
-      msg("Running dot for graph %d/%d\n",prev,numDotRuns);
-      dr->run();
-      prev++;
+      // collect the graphs that can be rendered by the same dot process
+      QList<DotRunner> batch;
+      batch.append(dr);
+      uint argLen = qstrlen(dr->file());
+      for (++li;batch.count()<(uint)m_batchSize && li.current();++li)
+      {
+        DotRunner *next = li.current();
+        if (!dr->canBatchWith(next) ||
+            argLen+qstrlen(next->file())+3>MAX_DOT_BATCH_ARGS)
+        {
+          break;
+        }
+        argLen+=qstrlen(next->file())+3;
+        batch.append(next);
+      }
+      uint j;
+      for (j=0;j<batch.count();j++)
+      {
+        msg("Running dot for graph %d/%d\n",prev,numDotRuns);
+        prev++;
+      }
+      DotRunner::runBatch(batch);
     }
   }
-  else // use multiple threads to run instances of dot in parallel
+  else // the runs were already added to the work queue by addRun()
   {
-    for (li.toFirst();(dr=li.current());++li)
-    {
-      m_queue->enqueue(dr);
-    }
+    flushPendingRuns();
     // wait for the queue to become empty
     while ((i=m_queue->count())>0)
     {
@@ -1400,9 +1728,10 @@ bool DotManager::run()
     }
   }
   portable_sysTimerStop();
-  if (setPath)
+  if (m_fontPathSet)
   {
     unsetDotFontPath();
+    m_fontPathSet=FALSE;
   }
 
   // patch the output file and insert the maps and figures
@@ -2311,19 +2640,20 @@ void DotGfxHierarchyTable::createGraph(DotNode *n,FTextStream &out,
   MD5SigToString(md5_sig,sigStr.rawData(),33);
   bool regenerate=FALSE;
   if (checkAndUpdateMd5Signature(absBaseName,sigStr) || 
-      !checkDeliverables(absImgName,absMapName))
+      !checkDeliverables(absBaseName,absImgName,absMapName))
   {
     regenerate=TRUE;
     // image was new or has changed
     QCString dotName=absBaseName+".dot";
-    QFile f(dotName);
-    if (!f.open(IO_WriteOnly)) return;
-    FTextStream t(&f);
-    t << theGraph;
-    f.close();
+    if (!DotManager::instance()->isScheduled(dotName) &&
+        !writeDotFile(dotName,theGraph.data()))
+    {
+      return;
+    }
     resetReNumbering();
 
     DotRunner *dotRun = new DotRunner(dotName,d.absPath().data(),TRUE,absImgName);
+    dotRun->setGraph(theGraph.data());
     dotRun->addJob(imgFmt,absImgName);
     dotRun->addJob(MAP_CMD,absMapName);
     DotManager::instance()->addRun(dotRun);
@@ -3092,19 +3422,19 @@ static bool updateDotGraph(DotNode *root,
                            bool lrRank,
                            bool renderParents,
                            bool backArrows,
+                           QCString &theGraph,
                            const QCString &title=QCString()
                           )
 {
-  QCString theGraph;
   // TODO: write graph to theGraph, then compute md5 checksum
   QCString md5 = computeMd5Signature(
                    root,gt,format,lrRank,renderParents,
                    backArrows,title,theGraph);
-  QFile f(baseName+".dot");
-  if (f.open(IO_WriteOnly))
+  QCString dotName = baseName+".dot";
+  // if dot was already started for the same graph, the file is up to date
+  if (!DotManager::instance()->isScheduled(dotName))
   {
-    FTextStream t(&f);
-    t << theGraph;
+    writeDotFile(dotName,theGraph);
   }
   return checkAndUpdateMd5Signature(baseName,md5); // graph needs to be regenerated
 }
@@ -3177,6 +3507,7 @@ QCString DotClassGraph::writeGraph(FTextStream &out,
   QCString absEpsName  = absBaseName+".eps";
   QCString absImgName  = absBaseName+"."+imgExt;
 
+  QCString theGraph;
   bool regenerate = FALSE;
   if (updateDotGraph(m_startNode,
                  m_graphType,
@@ -3185,9 +3516,10 @@ QCString DotClassGraph::writeGraph(FTextStream &out,
                  m_lrRank,
                  m_graphType==DotNode::Inheritance,
                  TRUE,
+                 theGraph,
                  m_startNode->label()
                 ) ||
-      !checkDeliverables(graphFormat==GOF_BITMAP ? absImgName : 
+      !checkDeliverables(absBaseName,graphFormat==GOF_BITMAP ? absImgName : 
                          usePDFLatex    ? absPdfName : absEpsName,
                          graphFormat==GOF_BITMAP && generateImageMap ? absMapName : QCString())
      )
@@ -3199,6 +3531,7 @@ QCString DotClassGraph::writeGraph(FTextStream &out,
                               d.absPath().data(),TRUE,absImgName);
       dotRun->addJob(imgFmt,absImgName);
       if (generateImageMap) dotRun->addJob(MAP_CMD,absMapName);
+      dotRun->setGraph(theGraph);
       DotManager::instance()->addRun(dotRun);
 
     }
@@ -3213,6 +3546,7 @@ QCString DotClassGraph::writeGraph(FTextStream &out,
       {
         dotRun->addJob("ps",absEpsName);
       }
+      dotRun->setGraph(theGraph);
       DotManager::instance()->addRun(dotRun);
     }
   }
@@ -3534,6 +3868,7 @@ QCString DotInclDepGraph::writeGraph(FTextStream &out,
   QCString absEpsName  = absBaseName+".eps";
   QCString absImgName  = absBaseName+"."+imgExt;
 
+  QCString theGraph;
   bool regenerate = FALSE;
   if (updateDotGraph(m_startNode,
                  DotNode::Dependency,
@@ -3542,9 +3877,10 @@ QCString DotInclDepGraph::writeGraph(FTextStream &out,
                  FALSE,        // lrRank
                  FALSE,        // renderParents
                  m_inverse,    // backArrows
+                 theGraph,     // graph text
                  m_startNode->label()
                 ) ||
-      !checkDeliverables(graphFormat==GOF_BITMAP ? absImgName :
+      !checkDeliverables(absBaseName,graphFormat==GOF_BITMAP ? absImgName :
                          usePDFLatex ? absPdfName : absEpsName,
                          graphFormat==GOF_BITMAP && generateImageMap ? absMapName : QCString())
      )
@@ -3556,6 +3892,7 @@ QCString DotInclDepGraph::writeGraph(FTextStream &out,
       DotRunner *dotRun = new DotRunner(absDotName,d.absPath().data(),TRUE,absImgName);
       dotRun->addJob(imgFmt,absImgName);
       if (generateImageMap) dotRun->addJob(MAP_CMD,absMapName);
+      dotRun->setGraph(theGraph);
       DotManager::instance()->addRun(dotRun);
     }
     else if (graphFormat==GOF_EPS)
@@ -3569,6 +3906,7 @@ QCString DotInclDepGraph::writeGraph(FTextStream &out,
       {
         dotRun->addJob("ps",absEpsName);
       }
+      dotRun->setGraph(theGraph);
       DotManager::instance()->addRun(dotRun);
     }
   }
@@ -3847,6 +4185,7 @@ QCString DotCallGraph::writeGraph(FTextStream &out, GraphOutputFormat graphForma
   QCString absEpsName  = absBaseName+".eps";
   QCString absImgName  = absBaseName+"."+imgExt;
 
+  QCString theGraph;
   bool regenerate = FALSE;
   if (updateDotGraph(m_startNode,
                  DotNode::CallGraph,
@@ -3855,9 +4194,10 @@ QCString DotCallGraph::writeGraph(FTextStream &out, GraphOutputFormat graphForma
                  TRUE,         // lrRank
                  FALSE,        // renderParents
                  m_inverse,    // backArrows
+                 theGraph,     // graph text
                  m_startNode->label()
                 ) ||
-      !checkDeliverables(graphFormat==GOF_BITMAP ? absImgName :
+      !checkDeliverables(absBaseName,graphFormat==GOF_BITMAP ? absImgName :
                          usePDFLatex ? absPdfName : absEpsName,
                          graphFormat==GOF_BITMAP && generateImageMap ? absMapName : QCString())
      )
@@ -3869,6 +4209,7 @@ QCString DotCallGraph::writeGraph(FTextStream &out, GraphOutputFormat graphForma
       DotRunner *dotRun = new DotRunner(absDotName,d.absPath().data(),TRUE,absImgName);
       dotRun->addJob(imgFmt,absImgName);
       if (generateImageMap) dotRun->addJob(MAP_CMD,absMapName);
+      dotRun->setGraph(theGraph);
       DotManager::instance()->addRun(dotRun);
 
     }
@@ -3884,6 +4225,7 @@ QCString DotCallGraph::writeGraph(FTextStream &out, GraphOutputFormat graphForma
       {
         dotRun->addJob("ps",absEpsName);
       }
+      dotRun->setGraph(theGraph);
       DotManager::instance()->addRun(dotRun);
 
     }
@@ -4015,21 +4357,18 @@ QCString DotDirDeps::writeGraph(FTextStream &out,
   MD5SigToString(md5_sig,sigStr.rawData(),33);
   bool regenerate=FALSE;
   if (checkAndUpdateMd5Signature(absBaseName,sigStr) ||
-      !checkDeliverables(graphFormat==GOF_BITMAP ? absImgName :
+      !checkDeliverables(absBaseName,graphFormat==GOF_BITMAP ? absImgName :
                          usePDFLatex ? absPdfName : absEpsName,
                          graphFormat==GOF_BITMAP && generateImageMap ? absMapName : QCString())
      )
   {
     regenerate=TRUE;
 
-    QFile f(absDotName);
-    if (!f.open(IO_WriteOnly))
+    if (!DotManager::instance()->isScheduled(absDotName) &&
+        !writeDotFile(absDotName,theGraph.data()))
     {
       err("Cannot create file %s.dot for writing!\n",baseName.data());
     }
-    FTextStream t(&f);
-    t << theGraph.data();
-    f.close();
 
     if (graphFormat==GOF_BITMAP)
     {
@@ -4037,6 +4376,7 @@ QCString DotDirDeps::writeGraph(FTextStream &out,
       DotRunner *dotRun = new DotRunner(absDotName,d.absPath().data(),TRUE,absImgName);
       dotRun->addJob(imgFmt,absImgName);
       if (generateImageMap) dotRun->addJob(MAP_CMD,absMapName);
+      dotRun->setGraph(theGraph.data());
       DotManager::instance()->addRun(dotRun);
     }
     else if (graphFormat==GOF_EPS)
@@ -4050,6 +4390,7 @@ QCString DotDirDeps::writeGraph(FTextStream &out,
       {
         dotRun->addJob("ps",absEpsName);
       }
+      dotRun->setGraph(theGraph.data());
       DotManager::instance()->addRun(dotRun);
     }
   }
@@ -4165,23 +4506,20 @@ void generateGraphLegend(const char *path)
   QCString imgName     = "graph_legend."+imgExt;
   QCString absImgName  = absBaseName+"."+imgExt;
   if (checkAndUpdateMd5Signature(absBaseName,sigStr) ||
-      !checkDeliverables(absImgName))
+      !checkDeliverables(absBaseName,absImgName))
   {
-    QFile dotFile(absDotName);
-    if (!dotFile.open(IO_WriteOnly))
+    if (!DotManager::instance()->isScheduled(absDotName) &&
+        !writeDotFile(absDotName,theGraph.data()))
     {
-      err("Could not open file %s for writing\n",dotFile.name().data());
+      err("Could not open file %s for writing\n",absDotName.data());
       return;
     }
 
-    FTextStream dotText(&dotFile); 
-    dotText << theGraph;
-    dotFile.close();
-
     // run dot to generate the a bitmap image from the graph
 
     DotRunner *dotRun = new DotRunner(absDotName,d.absPath().data(),TRUE,absImgName);
     dotRun->addJob(imgFmt,absImgName);
+    dotRun->setGraph(theGraph.data());
     DotManager::instance()->addRun(dotRun);
   }
   else
@@ -4574,19 +4912,16 @@ QCString DotGroupCollaboration::writeGraph( FTextStream &t,
   QCString absEpsName  = absBaseName+".eps";
   bool regenerate=FALSE;
   if (checkAndUpdateMd5Signature(absBaseName,sigStr) ||
-      !checkDeliverables(graphFormat==GOF_BITMAP ? absImgName :
+      !checkDeliverables(absBaseName,graphFormat==GOF_BITMAP ? absImgName :
                          usePDFLatex ? absPdfName : absEpsName,
                          graphFormat==GOF_BITMAP /*&& generateImageMap*/ ? absMapName : QCString())
      )
   {
     regenerate=TRUE;
 
-    QFile dotfile(absDotName);
-    if (dotfile.open(IO_WriteOnly))
+    if (!DotManager::instance()->isScheduled(absDotName))
     {
-      FTextStream tdot(&dotfile);
-      tdot << theGraph;
-      dotfile.close();
+      writeDotFile(absDotName,theGraph.data());
     }
 
     if (graphFormat==GOF_BITMAP) // run dot to create a bitmap image
@@ -4594,6 +4929,7 @@ QCString DotGroupCollaboration::writeGraph( FTextStream &t,
       DotRunner *dotRun = new DotRunner(absDotName,d.absPath().data(),FALSE);
       dotRun->addJob(imgFmt,absImgName);
       if (writeImageMap) dotRun->addJob(MAP_CMD,absMapName);
+      dotRun->setGraph(theGraph.data());
       DotManager::instance()->addRun(dotRun);
 
     }
@@ -4608,6 +4944,7 @@ QCString DotGroupCollaboration::writeGraph( FTextStream &t,
       {
         dotRun->addJob("ps",absEpsName);
       }
+      dotRun->setGraph(theGraph.data());
       DotManager::instance()->addRun(dotRun);
     }
 
@@ -375,14 +375,40 @@ class DotRunner
 
     void preventCleanUp() { m_cleanUp = FALSE; }
 
+    /** Sets the contents of the dot file. When graphs are rendered
+     *  in-process, this avoids reading the file back from disk.
+     */
+    void setGraph(const QCString &graph);
+
     /** Runs dot for all jobs added. */
     bool run();
     const CleanupItem &cleanup() const { return m_cleanupItem; }
+    const char *file() const { return m_file.data(); }
+    /** Returns a string that identifies the dot file and the outputs
+     *  produced from it by this run.
+     */
+    QCString key() const;
+
+    /** Returns TRUE if this run and \a other can be done by the
+     *  same dot process, i.e. if they produce the same output formats.
+     */
+    bool canBatchWith(const DotRunner *other) const;
+
+    /** Runs a single dot process for all \a runners, which should be
+     *  compatible according to canBatchWith().
+     */
+    static void runBatch(const QList<DotRunner> &runners);
 
   private:
+    bool finishRun();
+
     DotConstString m_dotExe;
     bool m_multiTargets;
+    bool m_inProcess; // render with the Graphviz library instead of dot
     QList<DotConstString> m_jobs;
+    QList<DotConstString> m_formats;
+    QList<DotConstString> m_outputs;
+    DotConstString m_graph;
     DotConstString m_postArgs;
     DotConstString m_postCmd;
     DotConstString m_file;
@@ -430,7 +456,15 @@ class DotRunnerQueue
 {
   public:
     void enqueue(DotRunner *runner);
+    /** Adds all \a runners at once, so a waiting worker can take them
+     *  as a single batch.
+     */
+    void enqueueBatch(const QList<DotRunner> &runners);
     DotRunner *dequeue();
+    /** Takes up to \a maxCount compatible runners from the queue. The
+     *  list is empty when the terminator was dequeued.
+     */
+    void dequeueBatch(QList<DotRunner> &runners,uint maxCount);
     uint count() const;
   private:
     QWaitCondition  m_bufferNotEmpty;
@@ -442,20 +476,31 @@ class DotRunnerQueue
 class DotWorkerThread : public QThread
 {
   public:
-    DotWorkerThread(DotRunnerQueue *queue);
+    DotWorkerThread(DotRunnerQueue *queue,int batchSize);
     void run();
     void cleanup();
   private:
     DotRunnerQueue *m_queue;
+    int             m_batchSize;
     QList<DotRunner::CleanupItem> m_cleanupItems;
 };
 
-/** Singleton that manages dot relation actions */
+/** Singleton that manages dot relation actions.
+ *
+ *  When worker threads are used, dot runs are handed to the workers as
+ *  soon as they are added, so the graphs are generated while doxygen
+ *  writes the remaining pages. Patching the output files with the
+ *  resulting maps and figures is done by run(), after all runs finished.
+ */
 class DotManager
 {
   public:
     static DotManager *instance();
     void addRun(DotRunner *run);
+    /** Returns TRUE if a run for dot file \a file was already added. The
+     *  file should then not be written again as dot may be reading it.
+     */
+    bool isScheduled(const QCString &file) const { return m_dotFiles.find(file)!=0; }
     int  addMap(const QCString &file,const QCString &mapFile,
                 const QCString &relPath,bool urlOnly,
                 const QCString &context,const QCString &label);
@@ -470,11 +515,17 @@ class DotManager
   private:
     DotManager();
     virtual ~DotManager();
+    void flushPendingRuns();
     QList<DotRunner>       m_dotRuns;
+    QList<DotRunner>       m_pendingRuns; // runs not yet queued, see addRun()
+    QDict<void>            m_dotFiles;   // dot files of the runs added
+    QDict<void>            m_dotRunKeys; // DotRunner::key() of the runs added
     SDict<DotFilePatcher> m_dotMaps;
     static DotManager     *m_theInstance;
     DotRunnerQueue        *m_queue;
     QList<DotWorkerThread> m_workers;
+    bool                   m_fontPathSet;
+    int                    m_batchSize;
 };
 
 
@@ -28,6 +28,9 @@
 #include <errno.h>
 #include <qptrdict.h>
 #include <qtextstream.h>
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
 
 #include "version.h"
 #include "doxygen.h"
@@ -98,6 +101,11 @@
 #include "settings.h"
 #include "context.h"
 #include "fileparser.h"
+#include "parsecache.h"
+#include "doccache.h"
+#include "lookupcache.h"
+#include "plantuml.h"
+#include "diagramjobs.h"
 
 // provided by the generated file resources.cpp
 extern void initResources();
@@ -153,7 +161,7 @@ QDict<DefinitionIntf> *Doxygen::symbolMap = 0;
 QDict<Definition> *Doxygen::clangUsrMap = 0;
 bool             Doxygen::outputToWizard=FALSE;
 QDict<int> *     Doxygen::htmlDirMap = 0;
-QCache<LookupInfo> *Doxygen::lookupCache;
+LookupCache       *Doxygen::lookupCache;
 DirSDict        *Doxygen::directories;
 SDict<DirRelation> Doxygen::dirRelations(257);
 ParserManager   *Doxygen::parserManager = 0;
@@ -218,11 +226,15 @@ class Statistics
       msg(name);
       stat *entry= new stat(name,0);
       stats.append(entry);
+      getCounters(entry->start);
       time.restart();
     }
     void end()
     {
-      stats.getLast()->elapsed=((double)time.elapsed())/1000.0;
+      stat *entry=stats.getLast();
+      entry->elapsed=((double)time.elapsed())/1000.0;
+      getCounters(entry->finish);
+      entry->peakMemory=portable_getPeakMemoryUsage();
     }
     void print()
     {
@@ -241,14 +253,119 @@ class Statistics
       }
       if (restore) Debug::setFlag("time");
     }
+    /** Writes the statistics for all steps as a JSON file */
+    void writeJson(const char *fileName)
+    {
+      QFile f(fileName);
+      if (!f.open(IO_WriteOnly))
+      {
+        err("Could not open file %s for writing\n",fileName);
+        return;
+      }
+      FTextStream t(&f);
+      Counters total;
+      getCounters(total);
+      t << "{\n";
+      t << "  \"version\": \"" << versionString << "\",\n";
+      t << "  \"elapsed\": " << ((double)Doxygen::runningTime.elapsed())/1000.0 << ",\n";
+      t << "  \"external_tools\": " << portable_getSysElapsedTime() << ",\n";
+      t << "  \"cpu\": " << total.cpuTime << ",\n";
+      t << "  \"peak_memory_kb\": " << portable_getPeakMemoryUsage() << ",\n";
+      t << "  \"entries_loaded\": " << total.entryLoads << ",\n";
+      t << "  \"entries_saved\": " << total.entrySaves << ",\n";
+      t << "  \"files_written\": " << total.filesWritten << ",\n";
+      t << "  \"doc_nodes\": " << total.docNodes << ",\n";
+      t << "  \"doc_node_blocks\": " << total.docNodeBlocks << ",\n";
+      if (Doxygen::lookupCache)
+      {
+        t << "  \"lookup_cache\": { \"size\": " << Doxygen::lookupCache->size()
+          << ", \"used\": " << Doxygen::lookupCache->count()
+          << ", \"hits\": " << total.lookupHits
+          << ", \"misses\": " << total.lookupMisses << " },\n";
+      }
+      t << "  \"steps\": [";
+      QListIterator<stat> sli(stats);
+      stat *s;
+      bool first=TRUE;
+      for ( sli.toFirst(); (s=sli.current()); ++sli )
+      {
+        if (!first) t << ",";
+        first=FALSE;
+        t << "\n    { \"name\": \"" << jsonName(s->name) << "\""
+          << ", \"elapsed\": " << s->elapsed
+          << ", \"cpu\": " << s->finish.cpuTime-s->start.cpuTime
+          << ", \"peak_memory_kb\": " << s->peakMemory
+          << ", \"lookup_hits\": " << s->finish.lookupHits-s->start.lookupHits
+          << ", \"lookup_misses\": " << s->finish.lookupMisses-s->start.lookupMisses
+          << ", \"entries_loaded\": " << s->finish.entryLoads-s->start.entryLoads
+          << ", \"entries_saved\": " << s->finish.entrySaves-s->start.entrySaves
+          << ", \"files_written\": " << s->finish.filesWritten-s->start.filesWritten
+          << ", \"doc_nodes\": " << s->finish.docNodes-s->start.docNodes
+          << ", \"doc_node_blocks\": " << s->finish.docNodeBlocks-s->start.docNodeBlocks
+          << " }";
+      }
+      t << "\n  ]\n";
+      t << "}\n";
+    }
   private:
+    struct Counters
+    {
+      Counters() : cpuTime(0), lookupHits(0), lookupMisses(0),
+                   entryLoads(0), entrySaves(0), filesWritten(0),
+                   docNodes(0), docNodeBlocks(0) {}
+      double cpuTime;
+      uint   lookupHits;
+      uint   lookupMisses;
+      int    entryLoads;
+      int    entrySaves;
+      int    filesWritten;
+      int    docNodes;
+      int    docNodeBlocks;
+    };
     struct stat
     {
       const char *name;
       double elapsed;
-      stat() : name(NULL),elapsed(0) {}
-      stat(const char *n, double el) : name(n),elapsed(el) {}
+      long peakMemory;
+      Counters start;
+      Counters finish;
+      stat() : name(NULL),elapsed(0),peakMemory(0) {}
+      stat(const char *n, double el) : name(n),elapsed(el),peakMemory(0) {}
     };
+    static void getCounters(Counters &c)
+    {
+      c.cpuTime      = portable_getCpuTime();
+      c.lookupHits   = Doxygen::lookupCache ? Doxygen::lookupCache->hits()   : 0;
+      c.lookupMisses = Doxygen::lookupCache ? Doxygen::lookupCache->misses() : 0;
+      c.entryLoads   = EntryNav::numLoads;
+      c.entrySaves   = EntryNav::numSaves;
+      c.filesWritten = OutputGenerator::numPlainFiles;
+      c.docNodes     = DocNode::numAllocated;
+      c.docNodeBlocks = DocNode::numPoolBlocks;
+    }
+    /** Returns the step name without the trailing dots and newline,
+     *  escaped for use in a JSON string.
+     */
+    static QCString jsonName(const char *name)
+    {
+      QCString n = QCString(name).stripWhiteSpace();
+      while (n.right(1)==".") n=n.left(n.length()-1);
+      QCString result;
+      const char *p=n.data();
+      char c;
+      while (p && (c=*p++))
+      {
+        switch (c)
+        {
+          case '"':  result+="\\\""; break;
+          case '\\': result+="\\\\"; break;
+          case '\n': result+="\\n";  break;
+          case '\t': result+="\\t";  break;
+          default:   result+=c;      break;
+        }
+      }
+      return result;
+    }
     QList<stat> stats;
     QTime       time;
 } g_s;
@@ -7814,6 +7931,200 @@ static void buildCompleteMemberLists()
 
 //----------------------------------------------------------------------------
 
+/** Reads the input files ahead of the parser using a pool of worker
+ *  threads. The parser gets the file contents in the order of the input
+ *  list, so the result does not depend on the number of threads used.
+ *  The \a filter and \a isSourceCode arguments select the input filter
+ *  as for readInputFile().
+ */
+class InputFileReader
+{
+  public:
+    InputFileReader(const StringList &files,int numThreads,
+                    bool filter=TRUE,bool isSourceCode=FALSE);
+   ~InputFileReader();
+    /** Returns the raw contents of the next file in the list, waiting for
+     *  it to be read if needed. The caller takes ownership of the buffer.
+     *  Returns 0 if the file could not be read.
+     */
+    BufStr *next();
+    /** Returns FALSE if no worker thread could be started, in which case
+     *  the reader cannot be used.
+     */
+    bool isActive() const { return m_workers.count()>0; }
+
+  private:
+    friend class InputFileReaderThread;
+    struct Job
+    {
+      Job(const char *fn,const char *filter)
+        : fileName(fn), filterName(filter), buf(0), done(FALSE) {}
+      QCString fileName;
+      QCString filterName;
+      BufStr  *buf;
+      bool     done;
+    };
+    Job *take();
+    void finished(Job *job);
+
+    QList<Job>              m_jobs;
+    QList<QThread>          m_workers;
+    uint                    m_next;     // index of next job to read
+    uint                    m_consumed; // number of jobs handed to the parser
+    uint                    m_window;   // maximum number of jobs read ahead
+    bool                    m_stop;
+    QMutex                  m_mutex;
+    QWaitCondition          m_canRead;
+    QWaitCondition          m_jobDone;
+};
+
+/** Worker thread of the InputFileReader */
+class InputFileReaderThread : public QThread
+{
+  public:
+    InputFileReaderThread(InputFileReader *reader) : m_reader(reader) {}
+    void run()
+    {
+      InputFileReader::Job *job;
+      while ((job=m_reader->take()))
+      {
+        QFileInfo fi(job->fileName);
+        if (fi.exists())
+        {
+          // a file that cannot be read is read again by the parser,
+          // which then reports the error
+          BufStr *buf = new BufStr(fi.size()+4096);
+          if (readRawInputFile(job->fileName,*buf,job->filterName,FALSE))
+          {
+            job->buf = buf;
+          }
+          else
+          {
+            delete buf;
+          }
+        }
+        m_reader->finished(job);
+      }
+    }
+  private:
+    InputFileReader *m_reader;
+};
+
+InputFileReader::InputFileReader(const StringList &files,int numThreads,
+                                 bool filter,bool isSourceCode)
+  : m_next(0), m_consumed(0), m_window(numThreads*4), m_stop(FALSE)
+{
+  m_jobs.setAutoDelete(TRUE);
+  m_workers.setAutoDelete(TRUE);
+  // determine the filters up front as the configuration is not thread safe
+  StringListIterator it(files);
+  QCString *s;
+  for (;(s=it.current());++it)
+  {
+    QCString filterName;
+    if (filter) filterName = getFileFilter(s->data(),isSourceCode);
+    m_jobs.append(new Job(s->data(),filterName.data()));
+  }
+  int i;
+  for (i=0;i<numThreads;i++)
+  {
+    InputFileReaderThread *thread = new InputFileReaderThread(this);
+    thread->start();
+    if (thread->isRunning())
+    {
+      m_workers.append(thread);
+    }
+    else // no more threads available!
+    {
+      delete thread;
+    }
+  }
+}
+
+InputFileReader::~InputFileReader()
+{
+  m_mutex.lock();
+  m_stop=TRUE;
+  m_canRead.wakeAll();
+  m_mutex.unlock();
+  QListIterator<QThread> ti(m_workers);
+  QThread *thread;
+  for (;(thread=ti.current());++ti)
+  {
+    thread->wait();
+  }
+  QListIterator<Job> ji(m_jobs);
+  Job *job;
+  for (;(job=ji.current());++ji)
+  {
+    delete job->buf;
+  }
+}
+
+InputFileReader::Job *InputFileReader::take()
+{
+  QMutexLocker locker(&m_mutex);
+  while (!m_stop && m_next<m_jobs.count() && m_next>=m_consumed+m_window)
+  {
+    // wait until the parser has caught up
+    m_canRead.wait(&m_mutex);
+  }
+  if (m_stop || m_next>=m_jobs.count()) return 0;
+  return m_jobs.at(m_next++);
+}
+
+void InputFileReader::finished(Job *job)
+{
+  QMutexLocker locker(&m_mutex);
+  job->done=TRUE;
+  m_jobDone.wakeAll();
+}
+
+BufStr *InputFileReader::next()
+{
+  QMutexLocker locker(&m_mutex);
+  ASSERT(m_consumed<m_jobs.count());
+  Job *job = m_jobs.at(m_consumed);
+  while (!job->done)
+  {
+    m_jobDone.wait(&m_mutex);
+  }
+  BufStr *result = job->buf;
+  job->buf = 0;
+  m_consumed++;
+  m_canRead.wakeAll();
+  return result;
+}
+
+//----------------------------------------------------------------------------
+
+/*! Returns the contents of source file \a fd as read ahead by \a reader,
+ *  in the form returned by fileToString(). Returns a null string if
+ *  there is no reader or the file could not be read, in which case
+ *  the file is read again by the caller.
+ */
+static QCString readAheadSource(InputFileReader *reader,FileDef *fd)
+{
+  QCString result;
+  if (reader==0) return result;
+  BufStr *buf = reader->next();
+  if (buf)
+  {
+    convertInputBuffer(fd->absFilePath(),*buf);
+    int pos = buf->curPos();
+    if (pos>1 && buf->at(pos-2)!='\n')
+    {
+      buf->at(pos-1)='\n';
+      buf->addChar(0);
+    }
+    result = buf->data();
+    delete buf;
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+
 static void generateFileSources()
 {
   if (Doxygen::inputNameList->count()>0)
@@ -7925,6 +8236,43 @@ static void generateFileSources()
     else
 #endif
     {
+      static bool filterSourceFiles = Config_getBool("FILTER_SOURCE_FILES");
+      int numThreads = getNumProcThreads();
+      InputFileReader *reader = 0;
+      if (numThreads>1)
+      {
+        // collect the files passed to the code parser below, in the same order
+        StringList sourceFiles;
+        sourceFiles.setAutoDelete(TRUE);
+        FileNameListIterator fnli(*Doxygen::inputNameList);
+        FileName *fn;
+        for (;(fn=fnli.current());++fnli)
+        {
+          FileNameIterator fni(*fn);
+          FileDef *fd;
+          for (;(fd=fni.current());++fni)
+          {
+            if ((fd->generateSourceFile() && !g_useOutputTemplate) ||
+                (!fd->isReference() && Doxygen::parseSourcesNeeded))
+            {
+              sourceFiles.append(new QCString(fd->absFilePath()));
+            }
+          }
+        }
+        if (sourceFiles.count()>1)
+        {
+          reader = new InputFileReader(sourceFiles,numThreads,filterSourceFiles,TRUE);
+          if (reader->isActive())
+          {
+            msg("Reading source files using %d parallel threads...\n",numThreads);
+          }
+          else // no threads available, read the files one by one
+          {
+            delete reader;
+            reader=0;
+          }
+        }
+      }
       FileNameListIterator fnli(*Doxygen::inputNameList);
       FileName *fn;
       for (;(fn=fnli.current());++fnli)
@@ -7938,18 +8286,21 @@ static void generateFileSources()
           if (fd->generateSourceFile() && !g_useOutputTemplate) // sources need to be shown in the output
           {
             msg("Generating code for file %s...\n",fd->docName().data());
-            fd->writeSource(*g_outputList,FALSE,filesInSameTu);
+            QCString contents = readAheadSource(reader,fd);
+            fd->writeSource(*g_outputList,FALSE,filesInSameTu,contents);
 
           }
           else if (!fd->isReference() && Doxygen::parseSourcesNeeded)
             // we needed to parse the sources even if we do not show them
           {
             msg("Parsing code for file %s...\n",fd->docName().data());
-            fd->parseSource(FALSE,filesInSameTu);
+            QCString contents = readAheadSource(reader,fd);
+            fd->parseSource(FALSE,filesInSameTu,contents);
           }
           fd->finishParsing();
         }
       }
+      delete reader;
     }
   }
 }
@@ -8343,21 +8694,18 @@ static void findSectionsInDocumentation()
   if (Doxygen::mainPage) Doxygen::mainPage->findSectionsInDocumentation();
 }
 
+static bool lookupHasClass(const LookupInfo &li)
+{
+  return li.classDef!=0;
+}
+
 static void flushCachedTemplateRelations()
 {
   // remove all references to classes from the cache
   // as there can be new template instances in the inheritance path
   // to this class. Optimization: only remove those classes that
   // have inheritance instances as direct or indirect sub classes.
-  QCacheIterator<LookupInfo> ci(*Doxygen::lookupCache);
-  LookupInfo *li=0;
-  for (ci.toFirst();(li=ci.current());++ci)
-  {
-    if (li->classDef)
-    {
-      Doxygen::lookupCache->remove(ci.currentKey());
-    }
-  }
+  Doxygen::lookupCache->remove(lookupHasClass);
   // remove all cached typedef resolutions whose target is a
   // template class as this may now be a template instance
   MemberNameSDict::Iterator fnli(*Doxygen::functionNameSDict);
@@ -8393,6 +8741,11 @@ static void flushCachedTemplateRelations()
 
 //----------------------------------------------------------------------------
 
+static bool lookupIsUnresolved(const LookupInfo &li)
+{
+  return li.classDef==0 && li.typeDef==0;
+}
+
 static void flushUnresolvedRelations()
 {
   // Remove all unresolved references to classes from the cache.
@@ -8405,15 +8758,7 @@ static void flushUnresolvedRelations()
   // class B : public A {};
   // class C : public B::I {};
   //
-  QCacheIterator<LookupInfo> ci(*Doxygen::lookupCache);
-  LookupInfo *li=0;
-  for (ci.toFirst();(li=ci.current());++ci)
-  {
-    if (li->classDef==0 && li->typeDef==0)
-    {
-      Doxygen::lookupCache->remove(ci.currentKey());
-    }
-  }
+  Doxygen::lookupCache->remove(lookupIsUnresolved);
 
   MemberNameSDict::Iterator fnli(*Doxygen::functionNameSDict);
   MemberName *fn;
@@ -9320,9 +9665,16 @@ static ParserInterface *getParserForFile(const char *fn)
   return Doxygen::parserManager->getParser(extension);
 }
 
+//----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+
+/*! Parses input file \a fn. If \a rawBuf is not 0 it contains the file
+ *  as read by readRawInputFile(), otherwise the file is read here.
+ */
 static void parseFile(ParserInterface *parser,
                       Entry *root,EntryNav *rootNav,FileDef *fd,const char *fn,
-                      bool sameTu,QStrList &filesInSameTu)
+                      bool sameTu,QStrList &filesInSameTu,BufStr *rawBuf=0)
 {
 #if USE_LIBCLANG
   static bool clangAssistedParsing = Config_getBool("CLANG_ASSISTED_PARSING");
@@ -9347,21 +9699,54 @@ static void parseFile(ParserInterface *parser,
   if (Config_getBool("ENABLE_PREPROCESSING") &&
       parser->needsPreprocessing(extension))
   {
-    BufStr inBuf(fi.size()+4096);
     msg("Preprocessing %s...\n",fn);
-    readInputFile(fileName,inBuf);
-    preprocessFile(fileName,inBuf,preBuf);
+    if (rawBuf)
+    {
+      convertInputBuffer(fileName,*rawBuf);
+      preprocessFile(fileName,*rawBuf,preBuf);
+    }
+    else
+    {
+      BufStr inBuf(fi.size()+4096);
+      readInputFile(fileName,inBuf);
+      preprocessFile(fileName,inBuf,preBuf);
+    }
   }
   else // no preprocessing
   {
     msg("Reading %s...\n",fn);
-    readInputFile(fileName,preBuf);
+    if (rawBuf)
+    {
+      convertInputBuffer(fileName,*rawBuf);
+      preBuf.addArray(rawBuf->data(),rawBuf->curPos());
+    }
+    else
+    {
+      readInputFile(fileName,preBuf);
+    }
   }
   if (preBuf.data() && preBuf.curPos()>0 && *(preBuf.data()+preBuf.curPos()-1)!='\n')
   {
     preBuf.addChar('\n'); // add extra newline to help parser
   }
 
+  // reuse the result of a previous run if the input did not change
+  ParseCache *cache = ParseCache::instance();
+  QCString cacheKey;
+  if (cache->isEnabled() && !clangAssistedParsing &&
+      getLanguageFromFileName(fileName)!=SrcLangExt_VHDL)
+  {
+    cacheKey = cache->computeKey(fileName,preBuf.data(),preBuf.curPos());
+    Entry *cachedRoot = cache->load(cacheKey,fileName);
+    if (cachedRoot)
+    {
+      cachedRoot->createNavigationIndex(rootNav,g_storage,fd);
+      delete cachedRoot;
+      return;
+    }
+    cache->startParse();
+  }
+
   BufStr convBuf(preBuf.curPos()+1024);
 
   // convert multi-line C++ comments to C style comments
@@ -9377,6 +9762,11 @@ static void parseFile(ParserInterface *parser,
   // use language parse to parse the file
   parser->parseInput(fileName,convBuf.data(),root,sameTu,filesInSameTu);
 
+  if (!cacheKey.isEmpty())
+  {
+    cache->store(cacheKey,fileName,root);
+  }
+
   // store the Entry tree in a file and create an index to
   // navigate/load entries
   //printf("root->createNavigationIndex for %s\n",fd->name().data());
@@ -9457,6 +9847,21 @@ static void parseFiles(Entry *root,EntryNav *rootNav)
   else // normal pocessing
 #endif
   {
+    int numThreads = getNumProcThreads();
+    InputFileReader *reader = 0;
+    if (numThreads>1 && g_inputFiles.count()>1)
+    {
+      reader = new InputFileReader(g_inputFiles,numThreads);
+      if (reader->isActive())
+      {
+        msg("Reading input files using %d parallel threads...\n",numThreads);
+      }
+      else // no threads available, read the files one by one
+      {
+        delete reader;
+        reader=0;
+      }
+    }
     StringListIterator it(g_inputFiles);
     QCString *s;
     for (;(s=it.current());++it)
@@ -9467,9 +9872,15 @@ static void parseFiles(Entry *root,EntryNav *rootNav)
       ASSERT(fd!=0);
       ParserInterface * parser = getParserForFile(s->data());
       parser->startTranslationUnit(s->data());
-      parseFile(parser,root,rootNav,fd,s->data(),FALSE,filesInSameTu);
+      // if the file could not be read ahead, parseFile() will retry it
+      BufStr *rawBuf = reader ? reader->next() : 0;
+      parseFile(parser,root,rootNav,fd,s->data(),FALSE,filesInSameTu,rawBuf);
+      delete rawBuf;
     }
+    delete reader;
   }
+  ParseCache::instance()->finish();
+  ParseCache::deleteInstance();
 }
 
 // resolves a path that may include symlinks, if a recursive symlink is
@@ -9580,6 +9991,7 @@ int readDir(QFileInfo *fi,
   msg("Searching for files in directory %s\n", fi->absFilePath().data());
   //printf("killDict=%p count=%d\n",killDict,killDict->count());
 
+  static bool excludeSymlinks = Config_getBool("EXCLUDE_SYMLINKS");
   const QFileInfoList *list = dir.entryInfoList();
   if (list)
   {
@@ -9588,24 +10000,26 @@ int readDir(QFileInfo *fi,
 
     while ((cfi=it.current()))
     {
-      if (exclDict==0 || exclDict->find(cfi->absFilePath().utf8())==0)
+      // the absolute path is needed for several checks, compute it once
+      QCString absPath = cfi->absFilePath().utf8();
+      if (exclDict==0 || exclDict->find(absPath)==0)
       { // file should not be excluded
-        //printf("killDict->find(%s)\n",cfi->absFilePath().data());
+        //printf("killDict->find(%s)\n",absPath.data());
         if (!cfi->exists() || !cfi->isReadable())
         {
           if (errorIfNotExist)
           {
-            warn_uncond("source %s is not a readable file or directory... skipping.\n",cfi->absFilePath().data());
+            warn_uncond("source %s is not a readable file or directory... skipping.\n",absPath.data());
           }
         }
         else if (cfi->isFile() &&
-            (!Config_getBool("EXCLUDE_SYMLINKS") || !cfi->isSymLink()) &&
+            (!excludeSymlinks || !cfi->isSymLink()) &&
             (patList==0 || patternMatch(*cfi,patList)) &&
             !patternMatch(*cfi,exclPatList) &&
-            (killDict==0 || killDict->find(cfi->absFilePath().utf8())==0)
+            (killDict==0 || killDict->find(absPath)==0)
             )
         {
-          totalSize+=cfi->size()+cfi->absFilePath().length()+4;
+          totalSize+=cfi->size()+absPath.length()+4;
           QCString name=cfi->fileName().utf8();
           //printf("New file %s\n",name.data());
           if (fnDict)
@@ -9618,7 +10032,7 @@ int readDir(QFileInfo *fi,
             }
             else
             {
-              fn = new FileName(cfi->absFilePath().utf8(),name);
+              fn = new FileName(absPath,name);
               fn->append(fd);
               if (fnList) fnList->inSort(fn);
               fnDict->insert(name,fn);
@@ -9627,17 +10041,17 @@ int readDir(QFileInfo *fi,
           QCString *rs=0;
           if (resultList || resultDict)
           {
-            rs=new QCString(cfi->absFilePath().utf8());
+            rs=new QCString(absPath);
           }
           if (resultList) resultList->append(rs);
-          if (resultDict) resultDict->insert(cfi->absFilePath().utf8(),rs);
-          if (killDict) killDict->insert(cfi->absFilePath().utf8(),(void *)0x8);
+          if (resultDict) resultDict->insert(absPath,rs);
+          if (killDict) killDict->insert(absPath,(void *)0x8);
         }
         else if (recursive &&
-            (!Config_getBool("EXCLUDE_SYMLINKS") || !cfi->isSymLink()) &&
+            (!excludeSymlinks || !cfi->isSymLink()) &&
             cfi->isDir() &&
-            !patternMatch(*cfi,exclPatList) &&
-            cfi->fileName().at(0)!='.') // skip "." ".." and ".dir"
+            cfi->fileName().at(0)!='.' && // skip "." ".." and ".dir"
+            !patternMatch(*cfi,exclPatList))
         {
           cfi->setFile(cfi->absFilePath());
           totalSize+=readDir(cfi,fnList,fnDict,exclDict,
@@ -10069,6 +10483,7 @@ void initDoxygen()
 
 void cleanUpDoxygen()
 {
+  DocCache::deleteInstance();
   delete Doxygen::sectionDict;
   delete Doxygen::formulaNameDict;
   delete Doxygen::formulaDict;
@@ -10924,8 +11339,7 @@ void parseInput()
   if (cacheSize<0) cacheSize=0;
   if (cacheSize>9) cacheSize=9;
   uint lookupSize = 65536 << cacheSize;
-  Doxygen::lookupCache = new QCache<LookupInfo>(lookupSize,lookupSize);
-  Doxygen::lookupCache->setAutoDelete(TRUE);
+  Doxygen::lookupCache = new LookupCache(lookupSize);
 
 #ifdef HAS_SIGNALS
   signal(SIGINT, stopDoxygen);
@@ -11435,6 +11849,11 @@ void generateOutput()
     g_outputList->add(new RTFGenerator);
     RTFGenerator::init();
   }
+  int numThreads = getNumProcThreads();
+  if (numThreads>1 && g_outputList->count()>0)
+  {
+    OutputFileWriter::start(numThreads);
+  }
   if (Config_getBool("USE_HTAGS"))
   {
     Htags::useHtags = TRUE;
@@ -11562,6 +11981,12 @@ void generateOutput()
   writeTagFile();
   g_s.end();
 
+  if (OutputFileWriter::isActive())
+  {
+    // make sure all pages are on disk before they are post-processed
+    OutputFileWriter::stop();
+  }
+
   if (Config_getBool("DOT_CLEANUP"))
   {
     if (generateHtml)
@@ -11650,6 +12075,11 @@ void generateOutput()
     g_s.end();
   }
 
+  g_s.begin("Running PlantUML, mscgen and dia...\n");
+  PlantumlManager::instance()->run();
+  DiagramJobManager::instance()->run();
+  g_s.end();
+
   // copy static stuff
   if (generateHtml)
   {
@@ -11702,11 +12132,7 @@ void generateOutput()
   }
 
   int cacheParam;
-  msg("lookup cache used %d/%d hits=%d misses=%d\n",
-      Doxygen::lookupCache->count(),
-      Doxygen::lookupCache->size(),
-      Doxygen::lookupCache->hits(),
-      Doxygen::lookupCache->misses());
+  Doxygen::lookupCache->printStats();
   cacheParam = computeIdealCacheParam(Doxygen::lookupCache->misses()*2/3); // part of the cache is flushed, hence the 2/3 correction factor
   if (cacheParam>Config_getInt("LOOKUP_CACHE_SIZE"))
   {
@@ -11720,6 +12146,9 @@ void generateOutput()
          portable_getSysElapsedTime()
         );
     g_s.print();
+    QCString statsFile = Config_getString("OUTPUT_DIRECTORY")+"/doxygen_statistics.json";
+    msg("Writing statistics to %s\n",statsFile.data());
+    g_s.writeJson(statsFile);
   }
   else
   {
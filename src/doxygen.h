@@ -58,6 +58,7 @@ class DefinitionIntf;
 class DirSDict;
 class DirRelation;
 class IndexList;
+class LookupCache;
 class FormulaList;
 class FormulaDict;
 class FormulaNameDict;
@@ -135,7 +136,7 @@ class Doxygen
     static QDict<Definition>        *clangUsrMap;
     static bool                      outputToWizard;
     static QDict<int>               *htmlDirMap;
-    static QCache<LookupInfo>       *lookupCache;
+    static LookupCache              *lookupCache;
     static DirSDict                 *directories;
     static SDict<DirRelation>        dirRelations;
     static ParserManager            *parserManager;
@@ -327,6 +327,8 @@ Entry *Entry::removeSubEntry(Entry *e)
 
 //------------------------------------------------------------------
 
+int EntryNav::numLoads=0;
+int EntryNav::numSaves=0;
 
 EntryNav::EntryNav(EntryNav *parent, Entry *e)
              : m_parent(parent), m_subList(0), m_section(e->section), m_type(e->type),
@@ -398,6 +400,7 @@ bool EntryNav::loadEntry(FileStorage *storage)
   }
   if (m_info)  delete m_info;
   m_info = unmarshalEntry(storage);
+  numLoads++;
   m_info->name = m_name;
   m_info->type = m_type;
   m_info->section = m_section;
@@ -409,6 +412,7 @@ bool EntryNav::saveEntry(Entry *e,FileStorage *storage)
   m_offset = storage->pos();
   //printf("EntryNav::saveEntry offset=%llx\n",m_offset);
   marshalEntry(storage,e);
+  numSaves++;
   return TRUE;
 }
 
@@ -353,6 +353,9 @@ class EntryNav
     EntryNav *parent() const { return m_parent; }
     FileDef *fileDef() const { return m_fileDef; }
 
+    static int numLoads;        //!< counts the entries read from storage
+    static int numSaves;        //!< counts the entries written to storage
+
   private:
 
     // navigation 
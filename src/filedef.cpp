@@ -908,8 +908,11 @@ void FileDef::writeQuickMemberLinks(OutputList &ol,MemberDef *currentMd) const
   ol.writeString("      </div>\n");
 }
 
-/*! Write a source listing of this file to the output */
-void FileDef::writeSource(OutputList &ol,bool sameTu,QStrList &filesInSameTu)
+/*! Write a source listing of this file to the output. If \a contents is
+ *  not null it is used as the (already read and filtered) text of the file.
+ */
+void FileDef::writeSource(OutputList &ol,bool sameTu,QStrList &filesInSameTu,
+                          const QCString &contents)
 {
   static bool generateTreeView  = Config_getBool("GENERATE_TREEVIEW");
   static bool filterSourceFiles = Config_getBool("FILTER_SOURCE_FILES");
@@ -1004,7 +1007,7 @@ void FileDef::writeSource(OutputList &ol,bool sameTu,QStrList &filesInSameTu)
                       );
     }
     pIntf->parseCode(ol,0,
-        fileToString(absFilePath(),filterSourceFiles,TRUE),
+        contents.isNull() ? fileToString(absFilePath(),filterSourceFiles,TRUE) : contents,
         getLanguage(),      // lang
         FALSE,              // isExampleBlock
         0,                  // exampleName
@@ -1024,7 +1027,8 @@ void FileDef::writeSource(OutputList &ol,bool sameTu,QStrList &filesInSameTu)
   ol.enableAll();
 }
 
-void FileDef::parseSource(bool sameTu,QStrList &filesInSameTu)
+void FileDef::parseSource(bool sameTu,QStrList &filesInSameTu,
+                          const QCString &contents)
 {
   static bool filterSourceFiles = Config_getBool("FILTER_SOURCE_FILES");
   DevNullCodeDocInterface devNullIntf;
@@ -1052,7 +1056,7 @@ void FileDef::parseSource(bool sameTu,QStrList &filesInSameTu)
     pIntf->resetCodeParserState();
     pIntf->parseCode(
             devNullIntf,0,
-            fileToString(absFilePath(),filterSourceFiles,TRUE),
+            contents.isNull() ? fileToString(absFilePath(),filterSourceFiles,TRUE) : contents,
             getLanguage(),
             FALSE,0,this
            );
@@ -150,8 +150,10 @@ class FileDef : public Definition
     void writeTagFile(FTextStream &t);
 
     void startParsing();
-    void writeSource(OutputList &ol,bool sameTu,QStrList &filesInSameTu);
-    void parseSource(bool sameTu,QStrList &filesInSameTu);
+    void writeSource(OutputList &ol,bool sameTu,QStrList &filesInSameTu,
+                     const QCString &contents=QCString());
+    void parseSource(bool sameTu,QStrList &filesInSameTu,
+                     const QCString &contents=QCString());
     void finishParsing();
 
     friend void generatedFileNames();
@@ -15,7 +15,9 @@
 
 #include <qfile.h>
 #include <assert.h>
+#include <string.h>
 #include "store.h"
+#include "portable.h"
 
 
 #ifndef FILESTORAGE_H
@@ -23,113 +25,68 @@
 
 /** @brief Store implementation based on a file. 
     Writing is linear, after that the file is re-opened for reading.
-    Reading is random (seek+read).
+    Reading is random (seek+read). For reading the file is mapped into
+    memory if the platform supports it, so a read is a plain memory copy
+    instead of a call into the C library.
  */
 class FileStorage : public StorageIntf
 {
   public:
-    FileStorage() : m_readOnly(FALSE) {}
-    FileStorage( const QString &name) : 
-                    m_readOnly(FALSE)    { m_file.setName(name); }
-    int read(char *buf,uint size)        { return m_file.readBlock(buf,size); }
-    int write(const char *buf,uint size) { assert(m_readOnly==FALSE); return m_file.writeBlock(buf,size); }
-    bool open( int m )                   { m_readOnly = m==IO_ReadOnly; return m_file.open(m); }
-    bool seek(int64 pos)                 { return m_file.seek(pos); }
-    int64 pos() const                    { return m_file.pos(); }
-    void close()                         { m_file.close(); }
-    void setName( const char *name )     { m_file.setName(name); }
-  private:
-    bool m_readOnly;
-    QFile m_file;
-};
-
-#if 0 // experimental version using mmap after opening the file as read only.
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <string.h>
-#include <unistd.h>
-#include <stdio.h>
-
-class FileStorage : public StorageIntf
-{
-  public:
-    FileStorage() : m_readOnly(FALSE), m_map(0), m_off(0), m_size(0) {}
+    FileStorage() : m_readOnly(FALSE), m_map(0), m_mapSize(0), m_mapPos(0) {}
     FileStorage( const QString &name) : 
-                    m_readOnly(FALSE)    { m_file.setName(name); }
-    void setName( const char *name )     { m_file.setName(name); }
-    bool open( int m )                   
-    { 
-      if (m==IO_ReadOnly)
-      {
-        m_readOnly=TRUE;
-        QString name = m_file.name();
-        m_file.close();
-        m_fd = ::open(name.data(),O_RDONLY);
-        struct stat stat;
-        fstat(m_fd,&stat);
-        m_size = stat.st_size;
-        m_map = mmap(NULL,m_size,PROT_READ,MAP_SHARED,m_fd,0);
-        if (m_map==MAP_FAILED) perror("mmap failed");
-        assert(m_map!=MAP_FAILED);
-        m_off = 0;
-        return TRUE;
-      }
-      else
+                    m_readOnly(FALSE), m_map(0), m_mapSize(0), m_mapPos(0)
+                                         { m_file.setName(name); }
+   ~FileStorage()                        { unmap(); }
+    int read(char *buf,uint size)
+    {
+      if (m_map)
       {
-        m_readOnly = FALSE;
-        return m_file.open(m); 
+        if (m_mapPos+size>m_mapSize) size = (uint)(m_mapSize-m_mapPos);
+        memcpy(buf,m_map+m_mapPos,size);
+        m_mapPos+=size;
+        return size;
       }
+      return m_file.readBlock(buf,size);
     }
-    int write(const char *buf,uint size) 
-    { 
-      assert(m_map==0);
-      return m_file.writeBlock(buf,size); 
-    }
-    int read(char *buf,uint size)        
-    { 
-      assert(m_map!=0);
-      memcpy(buf,((char *)m_map)+m_off,size); 
-      m_off+=size; 
-      return size; 
-    }
-    bool seek(int64 pos)                 
-    { 
-      m_off=pos; 
-      return TRUE; 
-    }
-    int64 pos() const                    
-    { 
+    int write(const char *buf,uint size) { assert(m_readOnly==FALSE); return m_file.writeBlock(buf,size); }
+    bool open( int m )
+    {
+      m_readOnly = m==IO_ReadOnly;
       if (m_readOnly)
       {
-        return m_off; 
-      }
-      else
-      {
-        return m_file.pos();
+        m_map = portable_mapFile(QFile::encodeName(m_file.name()),m_mapSize);
+        m_mapPos = 0;
+        if (m_map) return TRUE;
       }
+      // fall back to normal file access
+      return m_file.open(m);
     }
-    void close()                         
-    { 
-      if (m_readOnly)
+    bool seek(int64 pos)
+    {
+      if (m_map)
       {
-        munmap(m_map,m_size); 
-        ::close(m_fd);
-        exit(1);
+        if (pos<0 || pos>m_mapSize) return FALSE;
+        m_mapPos=pos;
+        return TRUE;
       }
-      else
+      return m_file.seek(pos);
+    }
+    int64 pos() const                    { return m_map ? (int64)m_mapPos : m_file.pos(); }
+    void close()                         { unmap(); m_file.close(); }
+    void setName( const char *name )     { m_file.setName(name); }
+  private:
+    void unmap()
+    {
+      if (m_map)
       {
-        m_file.close();
+        portable_unmapFile(m_map,m_mapSize);
+        m_map=0;
       }
     }
-  private:
     bool m_readOnly;
     QFile m_file;
-    int m_fd;
-    void *m_map;
-    off_t m_off;
-    off_t m_size;
+    const char *m_map;
+    portable_off_t m_mapSize;
+    portable_off_t m_mapPos;
 };
 #endif
-
-#endif
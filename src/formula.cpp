@@ -19,6 +19,10 @@
 #include <qfileinfo.h>
 #include <qtextstream.h>
 #include <qdir.h>
+#include <qthread.h>
+#include <qmutex.h>
+
+#include "md5.h"
 
 #include "formula.h"
 #include "image.h"
@@ -46,19 +50,278 @@ int Formula::getId()
   return number;
 }
 
+/** A page of _formulas.dvi that is to be converted into a bitmap */
+struct FormulaPage
+{
+  FormulaPage(int n,int i,const QCString &c) 
+    : pageNum(n), pageIndex(i), cacheFile(c) {}
+  int      pageNum;   // number of the formula
+  int      pageIndex; // page in the dvi file
+  QCString cacheFile; // file to store the bitmap in the cache, or empty
+};
+
+/** Converts the page \a page of _formulas.dvi into the bitmap
+ *  form_N.png in the current directory, where N is the formula number.
+ *  The images are rendered at a scale depending on \a zoomFactor.
+ */
+static bool createFormulaBitmap(const FormulaPage *page,int zoomFactor)
+{
+  int x1=0,y1=0,x2=0,y2=0;
+  QDir thisDir;
+  int pageNum=page->pageNum;
+  char dviArgs[4096];
+  QCString formBase;
+  formBase.sprintf("_form%d",pageNum);
+  // run dvips to convert the page with number pageIndex to an
+  // encapsulated postscript.
+  sprintf(dviArgs,"-q -D 600 -E -n 1 -p %d -o %s.eps _formulas.dvi",
+      page->pageIndex,formBase.data());
+  if (portable_system("dvips",dviArgs)!=0)
+  {
+    err("Problems running dvips. Check your installation!\n");
+    return FALSE;
+  }
+  // now we read the generated postscript file to extract the bounding box
+  // this runs on a worker thread, so the file is read as is, without
+  // fileToString(), which uses the configuration
+  QFile epsFile(formBase+".eps");
+  if (epsFile.open(IO_ReadOnly))
+  {
+    QCString eps(epsFile.size()+1);
+    eps.resize(epsFile.readBlock(eps.rawData(),epsFile.size())+1);
+    epsFile.close();
+    int i=eps.find("%%BoundingBox:");
+    if (i!=-1)
+    {
+      sscanf(eps.data()+i,"%%%%BoundingBox:%d %d %d %d",&x1,&y1,&x2,&y2);
+    }
+    else
+    {
+      err("Couldn't extract bounding box!\n");
+    }
+  } 
+  // next we generate a postscript file which contains the eps
+  // and displays it in the right colors and the right bounding box
+  QFile f(formBase+".ps");
+  if (f.open(IO_WriteOnly))
+  {
+    FTextStream t(&f);
+    t << "1 1 1 setrgbcolor" << endl;  // anti-alias to white background
+    t << "newpath" << endl;
+    t << "-1 -1 moveto" << endl;
+    t << (x2-x1+2) << " -1 lineto" << endl;
+    t << (x2-x1+2) << " " << (y2-y1+2) << " lineto" << endl;
+    t << "-1 " << (y2-y1+2) << " lineto" <<endl;
+    t << "closepath" << endl;
+    t << "fill" << endl;
+    t << -x1 << " " << -y1 << " translate" << endl;
+    t << "0 0 0 setrgbcolor" << endl;
+    t << "(" << formBase << ".eps) run" << endl;
+    f.close();
+  }
+  // scale the image so that it is four times larger than needed.
+  // and the sizes are a multiple of four.
+  double scaleFactor = 16.0/3.0; 
+  scaleFactor *= zoomFactor/10.0;
+  int gx = (((int)((x2-x1)*scaleFactor))+3)&~1;
+  int gy = (((int)((y2-y1)*scaleFactor))+3)&~1;
+  // Then we run ghostscript to convert the postscript to a pixmap
+  // The pixmap is a truecolor image, where only black and white are
+  // used.  
+
+  char gsArgs[4096];
+  sprintf(gsArgs,"-q -g%dx%d -r%dx%dx -sDEVICE=ppmraw "
+                "-sOutputFile=%s.pnm -dNOPAUSE -dBATCH -- %s.ps",
+                gx,gy,(int)(scaleFactor*72),(int)(scaleFactor*72),
+                formBase.data(),formBase.data()
+         );
+  if (portable_system(portable_ghostScriptCommand(),gsArgs)!=0)
+  {
+    err("Problem running ghostscript %s %s. Check your installation!\n",portable_ghostScriptCommand(),gsArgs);
+    return FALSE;
+  }
+  f.setName(formBase+".pnm");
+  uint imageX=0,imageY=0;
+  // we read the generated image again, to obtain the pixel data.
+  if (f.open(IO_ReadOnly))
+  {
+    QTextStream t(&f);
+    QCString s;
+    if (!t.eof())
+      s=t.readLine().utf8();
+    if (s.length()<2 || s.left(2)!="P6")
+      err("ghostscript produced an illegal image format!");
+    else
+    {
+      // assume the size is after the first line that does not start with
+      // # excluding the first line of the file.
+      while (!t.eof() && (s=t.readLine().utf8()) && !s.isEmpty() && s.at(0)=='#') { }
+      sscanf(s,"%d %d",&imageX,&imageY);
+    }
+    if (imageX>0 && imageY>0)
+    {
+      //printf("Converting image...\n");
+      char *data = new char[imageX*imageY*3]; // rgb 8:8:8 format
+      uint i,x,y,ix,iy;
+      f.readBlock(data,imageX*imageY*3);
+      Image srcImage(imageX,imageY),
+            filteredImage(imageX,imageY),
+            dstImage(imageX/4,imageY/4);
+      uchar *ps=srcImage.getData();
+      // convert image to black (1) and white (0) index.
+      for (i=0;i<imageX*imageY;i++) *ps++= (data[i*3]==0 ? 1 : 0);
+      // apply a simple box filter to the image 
+      static int filterMask[]={1,2,1,2,8,2,1,2,1};
+      for (y=0;y<srcImage.getHeight();y++)
+      {
+        for (x=0;x<srcImage.getWidth();x++)
+        {
+          int s=0;
+          for (iy=0;iy<2;iy++)
+          {
+            for (ix=0;ix<2;ix++)
+            {
+              s+=srcImage.getPixel(x+ix-1,y+iy-1)*filterMask[iy*3+ix];
+            }
+          }
+          filteredImage.setPixel(x,y,s);
+        }
+      }
+      // down-sample the image to 1/16th of the area using 16 gray scale
+      // colors.
+      // TODO: optimize this code.
+      for (y=0;y<dstImage.getHeight();y++)
+      {
+        for (x=0;x<dstImage.getWidth();x++)
+        {
+          int xp=x<<2;
+          int yp=y<<2;
+          int c=filteredImage.getPixel(xp+0,yp+0)+
+                filteredImage.getPixel(xp+1,yp+0)+
+                filteredImage.getPixel(xp+2,yp+0)+
+                filteredImage.getPixel(xp+3,yp+0)+
+                filteredImage.getPixel(xp+0,yp+1)+
+                filteredImage.getPixel(xp+1,yp+1)+
+                filteredImage.getPixel(xp+2,yp+1)+
+                filteredImage.getPixel(xp+3,yp+1)+
+                filteredImage.getPixel(xp+0,yp+2)+
+                filteredImage.getPixel(xp+1,yp+2)+
+                filteredImage.getPixel(xp+2,yp+2)+
+                filteredImage.getPixel(xp+3,yp+2)+
+                filteredImage.getPixel(xp+0,yp+3)+
+                filteredImage.getPixel(xp+1,yp+3)+
+                filteredImage.getPixel(xp+2,yp+3)+
+                filteredImage.getPixel(xp+3,yp+3);
+          // here we scale and clip the color value so the
+          // resulting image has a reasonable contrast
+          dstImage.setPixel(x,y,QMIN(15,(c*15)/(16*10)));
+        }
+      }
+      // save the result as a bitmap
+      QCString resultName;
+      resultName.sprintf("form_%d.png",pageNum);
+      // the option parameter 1 is used here as a temporary hack
+      // to select the right color palette! 
+      dstImage.save(resultName,1);
+      delete[] data;
+      // keep a copy for later runs
+      if (!page->cacheFile.isEmpty())
+      {
+        QCString tmpFile;
+        tmpFile.sprintf("%s.%d.tmp",page->cacheFile.data(),pageNum);
+        if (copyFile(resultName,tmpFile))
+        {
+          thisDir.remove(page->cacheFile);
+          thisDir.rename(tmpFile,page->cacheFile);
+        }
+      }
+    }
+    f.close();
+  } 
+  // remove intermediate image files
+  thisDir.remove(formBase+".eps");
+  thisDir.remove(formBase+".pnm");
+  thisDir.remove(formBase+".ps");
+  return TRUE;
+}
+
+/** Work queue shared by the threads converting the formula pages */
+class FormulaPageQueue
+{
+  public:
+    FormulaPageQueue(const QList<FormulaPage> &pages,int zoomFactor) 
+      : m_pages(pages), m_next(0), m_zoomFactor(zoomFactor), m_error(FALSE) {}
+    /** Converts pages until none are left. Called from each thread. */
+    void run()
+    {
+      const FormulaPage *page;
+      while ((page=take()))
+      {
+        if (!createFormulaBitmap(page,m_zoomFactor))
+        {
+          QMutexLocker locker(&m_mutex);
+          m_error=TRUE;
+        }
+      }
+    }
+    bool hasError() const { return m_error; }
+
+  private:
+    const FormulaPage *take()
+    {
+      QMutexLocker locker(&m_mutex);
+      if (m_error || m_next>=m_pages.count()) return 0;
+      const FormulaPage *page = m_pages.at(m_next++);
+      msg("Generating image form_%d.png for formula\n",page->pageNum);
+      return page;
+    }
+    const QList<FormulaPage> &m_pages;
+    uint   m_next;
+    int    m_zoomFactor;
+    bool   m_error;
+    QMutex m_mutex;
+};
+
+/** Thread converting formula pages taken from a FormulaPageQueue */
+class FormulaWorkerThread : public QThread
+{
+  public:
+    FormulaWorkerThread(FormulaPageQueue *queue) : m_queue(queue) {}
+    void run() { m_queue->run(); }
+  private:
+    FormulaPageQueue *m_queue;
+};
+
 void FormulaList::generateBitmaps(const char *path)
 {
-  int x1,y1,x2,y2;
   QDir d(path);
   // store the original directory
   if (!d.exists()) { err("Output dir %s does not exist!\n",path); exit(1); }
   QCString oldDir = QDir::currentDirPath().utf8();
+  // images of formulas are kept in the cache directory (if set), named 
+  // after the MD5 of everything that determines their contents.
+  QCString cacheDir = Config_getString("FORMULA_CACHE_DIRECTORY");
+  if (!cacheDir.isEmpty())
+  {
+    QDir cd(cacheDir);
+    if (!cd.exists() && !cd.mkdir(cacheDir))
+    {
+      err("Could not create formula cache directory %s, formula cache disabled\n",cacheDir.data());
+      cacheDir.resize(0);
+    }
+    else
+    {
+      cacheDir = cd.absPath().utf8();
+    }
+  }
+  int zoomFactor = Config_getInt("FORMULA_FONTSIZE");
+  if (zoomFactor<8 || zoomFactor>50) zoomFactor=10;
   // go to the html output directory (i.e. path)
   QDir::setCurrent(d.absPath());
   QDir thisDir;
   // generate a latex file containing one formula per page.
   QCString texName="_formulas.tex";
-  QList<int> pagesToGenerate;
+  QList<FormulaPage> pagesToGenerate;
   pagesToGenerate.setAutoDelete(TRUE);
   FormulaListIterator fli(*this);
   Formula *formula;
@@ -68,31 +331,52 @@ void FormulaList::generateBitmaps(const char *path)
   {
     FTextStream t(&f);
     if (Config_getBool("LATEX_BATCHMODE")) t << "\\batchmode" << endl;
-    t << "\\documentclass{article}" << endl;
-    t << "\\usepackage{epsfig}" << endl; // for those who want to include images
+    QCString preamble;
+    preamble+="\\documentclass{article}\n";
+    preamble+="\\usepackage{epsfig}\n"; // for those who want to include images
     const char *s=Config_getList("EXTRA_PACKAGES").first();
     while (s)
     {
-      t << "\\usepackage{" << s << "}\n";
+      preamble+=QCString("\\usepackage{")+s+"}\n";
       s=Config_getList("EXTRA_PACKAGES").next();
     }
+    t << preamble;
     t << "\\pagestyle{empty}" << endl; 
     t << "\\begin{document}" << endl;
-    int page=0;
+    QCString settings;
+    settings.sprintf("%d %d\n",zoomFactor,Config_getBool("FORMULA_TRANSPARENT"));
+    settings+=preamble;
     for (fli.toFirst();(formula=fli.current());++fli)
     {
       QCString resultName;
       resultName.sprintf("form_%d.png",formula->getId());
-      // only formulas for which no image exists are generated
-      QFileInfo fi(resultName);
-      if (!fi.exists())
+      QCString cacheFile;
+      bool generate;
+      if (!cacheDir.isEmpty())
+      {
+        QCString text = settings+formula->getFormulaText();
+        uchar md5_sig[16];
+        QCString sigStr(33);
+        MD5Buffer((const unsigned char *)text.data(),text.length(),md5_sig);
+        MD5SigToString(md5_sig,sigStr.rawData(),33);
+        cacheFile = cacheDir+"/"+sigStr+".png";
+        // the image in the output directory may belong to another formula
+        // or settings, so the cache decides what needs to be generated
+        generate = !QFileInfo(cacheFile).exists() || !copyFile(cacheFile,resultName);
+      }
+      else
+      {
+        // only formulas for which no image exists are generated
+        generate = !QFileInfo(resultName).exists();
+      }
+      if (generate)
       {
         // we force a pagebreak after each formula
         t << formula->getFormulaText() << endl << "\\pagebreak\n\n";
-        pagesToGenerate.append(new int(page));
+        pagesToGenerate.append(new FormulaPage(formula->getId(),
+                               pagesToGenerate.count()+1,cacheFile));
       }
       Doxygen::indexList->addImageFile(resultName);
-      page++;
     }
     t << "\\end{document}" << endl;
     f.close();
@@ -112,182 +396,47 @@ void FormulaList::generateBitmaps(const char *path)
       //return;
     }
     portable_sysTimerStop();
-    //printf("Running dvips...\n");
-    QListIterator<int> pli(pagesToGenerate);
-    int *pagePtr;
-    int pageIndex=1;
-    for (;(pagePtr=pli.current());++pli,++pageIndex)
+    // convert the pages of the dvi file into images, using a thread per 
+    // processor since dvips and ghostscript are started for every formula.
+    int numThreads = getNumProcThreads();
+    numThreads = QMIN(numThreads,(int)pagesToGenerate.count());
+    FormulaPageQueue queue(pagesToGenerate,zoomFactor);
+    portable_sysTimerStart();
+    if (numThreads>1)
     {
-      int pageNum=*pagePtr;
-      msg("Generating image form_%d.png for formula\n",pageNum);
-      char dviArgs[4096];
-      QCString formBase;
-      formBase.sprintf("_form%d",pageNum);
-      // run dvips to convert the page with number pageIndex to an
-      // encapsulated postscript.
-      sprintf(dviArgs,"-q -D 600 -E -n 1 -p %d -o %s.eps _formulas.dvi",
-          pageIndex,formBase.data());
-      portable_sysTimerStart();
-      if (portable_system("dvips",dviArgs)!=0)
-      {
-        err("Problems running dvips. Check your installation!\n");
-        portable_sysTimerStop();
-        QDir::setCurrent(oldDir);
-        return;
-      }
-      portable_sysTimerStop();
-      // now we read the generated postscript file to extract the bounding box
-      QFileInfo fi(formBase+".eps");
-      if (fi.exists())
+      QList<FormulaWorkerThread> workers;
+      workers.setAutoDelete(TRUE);
+      int i;
+      for (i=0;i<numThreads;i++)
       {
-        QCString eps = fileToString(formBase+".eps");
-        int i=eps.find("%%BoundingBox:");
-        if (i!=-1)
+        FormulaWorkerThread *thread = new FormulaWorkerThread(&queue);
+        thread->start();
+        if (thread->isRunning())
         {
-          sscanf(eps.data()+i,"%%%%BoundingBox:%d %d %d %d",&x1,&y1,&x2,&y2);
+          workers.append(thread);
         }
-        else
+        else // no more threads available!
         {
-          err("Couldn't extract bounding box!\n");
+          delete thread;
         }
-      } 
-      // next we generate a postscript file which contains the eps
-      // and displays it in the right colors and the right bounding box
-      f.setName(formBase+".ps");
-      if (f.open(IO_WriteOnly))
-      {
-        FTextStream t(&f);
-        t << "1 1 1 setrgbcolor" << endl;  // anti-alias to white background
-        t << "newpath" << endl;
-        t << "-1 -1 moveto" << endl;
-        t << (x2-x1+2) << " -1 lineto" << endl;
-        t << (x2-x1+2) << " " << (y2-y1+2) << " lineto" << endl;
-        t << "-1 " << (y2-y1+2) << " lineto" <<endl;
-        t << "closepath" << endl;
-        t << "fill" << endl;
-        t << -x1 << " " << -y1 << " translate" << endl;
-        t << "0 0 0 setrgbcolor" << endl;
-        t << "(" << formBase << ".eps) run" << endl;
-        f.close();
       }
-      // scale the image so that it is four times larger than needed.
-      // and the sizes are a multiple of four.
-      double scaleFactor = 16.0/3.0; 
-      int zoomFactor = Config_getInt("FORMULA_FONTSIZE");
-      if (zoomFactor<8 || zoomFactor>50) zoomFactor=10;
-      scaleFactor *= zoomFactor/10.0;
-      int gx = (((int)((x2-x1)*scaleFactor))+3)&~1;
-      int gy = (((int)((y2-y1)*scaleFactor))+3)&~1;
-      // Then we run ghostscript to convert the postscript to a pixmap
-      // The pixmap is a truecolor image, where only black and white are
-      // used.  
-
-      char gsArgs[4096];
-      sprintf(gsArgs,"-q -g%dx%d -r%dx%dx -sDEVICE=ppmraw "
-                    "-sOutputFile=%s.pnm -dNOPAUSE -dBATCH -- %s.ps",
-                    gx,gy,(int)(scaleFactor*72),(int)(scaleFactor*72),
-                    formBase.data(),formBase.data()
-             );
-      portable_sysTimerStart();
-      if (portable_system(portable_ghostScriptCommand(),gsArgs)!=0)
+      QListIterator<FormulaWorkerThread> wli(workers);
+      FormulaWorkerThread *thread;
+      for (;(thread=wli.current());++wli)
       {
-        err("Problem running ghostscript %s %s. Check your installation!\n",portable_ghostScriptCommand(),gsArgs);
-        portable_sysTimerStop();
-        QDir::setCurrent(oldDir);
-        return;
+        thread->wait();
       }
-      portable_sysTimerStop();
-      f.setName(formBase+".pnm");
-      uint imageX=0,imageY=0;
-      // we read the generated image again, to obtain the pixel data.
-      if (f.open(IO_ReadOnly))
-      {
-        QTextStream t(&f);
-        QCString s;
-        if (!t.eof())
-          s=t.readLine().utf8();
-        if (s.length()<2 || s.left(2)!="P6")
-          err("ghostscript produced an illegal image format!");
-        else
-        {
-          // assume the size is after the first line that does not start with
-          // # excluding the first line of the file.
-          while (!t.eof() && (s=t.readLine().utf8()) && !s.isEmpty() && s.at(0)=='#') { }
-          sscanf(s,"%d %d",&imageX,&imageY);
-        }
-        if (imageX>0 && imageY>0)
-        {
-          //printf("Converting image...\n");
-          char *data = new char[imageX*imageY*3]; // rgb 8:8:8 format
-          uint i,x,y,ix,iy;
-          f.readBlock(data,imageX*imageY*3);
-          Image srcImage(imageX,imageY),
-                filteredImage(imageX,imageY),
-                dstImage(imageX/4,imageY/4);
-          uchar *ps=srcImage.getData();
-          // convert image to black (1) and white (0) index.
-          for (i=0;i<imageX*imageY;i++) *ps++= (data[i*3]==0 ? 1 : 0);
-          // apply a simple box filter to the image 
-          static int filterMask[]={1,2,1,2,8,2,1,2,1};
-          for (y=0;y<srcImage.getHeight();y++)
-          {
-            for (x=0;x<srcImage.getWidth();x++)
-            {
-              int s=0;
-              for (iy=0;iy<2;iy++)
-              {
-                for (ix=0;ix<2;ix++)
-                {
-                  s+=srcImage.getPixel(x+ix-1,y+iy-1)*filterMask[iy*3+ix];
-                }
-              }
-              filteredImage.setPixel(x,y,s);
-            }
-          }
-          // down-sample the image to 1/16th of the area using 16 gray scale
-          // colors.
-          // TODO: optimize this code.
-          for (y=0;y<dstImage.getHeight();y++)
-          {
-            for (x=0;x<dstImage.getWidth();x++)
-            {
-              int xp=x<<2;
-              int yp=y<<2;
-              int c=filteredImage.getPixel(xp+0,yp+0)+
-                    filteredImage.getPixel(xp+1,yp+0)+
-                    filteredImage.getPixel(xp+2,yp+0)+
-                    filteredImage.getPixel(xp+3,yp+0)+
-                    filteredImage.getPixel(xp+0,yp+1)+
-                    filteredImage.getPixel(xp+1,yp+1)+
-                    filteredImage.getPixel(xp+2,yp+1)+
-                    filteredImage.getPixel(xp+3,yp+1)+
-                    filteredImage.getPixel(xp+0,yp+2)+
-                    filteredImage.getPixel(xp+1,yp+2)+
-                    filteredImage.getPixel(xp+2,yp+2)+
-                    filteredImage.getPixel(xp+3,yp+2)+
-                    filteredImage.getPixel(xp+0,yp+3)+
-                    filteredImage.getPixel(xp+1,yp+3)+
-                    filteredImage.getPixel(xp+2,yp+3)+
-                    filteredImage.getPixel(xp+3,yp+3);
-              // here we scale and clip the color value so the
-              // resulting image has a reasonable contrast
-              dstImage.setPixel(x,y,QMIN(15,(c*15)/(16*10)));
-            }
-          }
-          // save the result as a bitmap
-          QCString resultName;
-          resultName.sprintf("form_%d.png",pageNum);
-          // the option parameter 1 is used here as a temporary hack
-          // to select the right color palette! 
-          dstImage.save(resultName,1);
-          delete[] data;
-        }
-        f.close();
-      } 
-      // remove intermediate image files
-      thisDir.remove(formBase+".eps");
-      thisDir.remove(formBase+".pnm");
-      thisDir.remove(formBase+".ps");
+      if (workers.count()==0) queue.run();
+    }
+    else
+    {
+      queue.run();
+    }
+    portable_sysTimerStop();
+    if (queue.hasError())
+    {
+      QDir::setCurrent(oldDir);
+      return;
     }
     // remove intermediate files produced by latex
     thisDir.remove("_formulas.dvi");
@@ -0,0 +1,293 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include <qmutex.h>
+
+#include "lookupcache.h"
+#include "doxygen.h"
+#include "message.h"
+
+#define INITIAL_SHARD_SIZE 1024
+
+//----------------------------------------------------------------------------
+
+static inline uint hashBytes(uint h,const char *p,uint len)
+{
+  // FNV-1a
+  while (len--)
+  {
+    h = (h ^ (uchar)*p++) * 16777619U;
+  }
+  return h;
+}
+
+static inline uint hashString(uint h,const char *s)
+{
+  while (*s)
+  {
+    h = (h ^ (uchar)*s++) * 16777619U;
+  }
+  return (h ^ 0xff) * 16777619U; // separator
+}
+
+static inline bool stringsEqual(const char *s1,const char *s2)
+{
+  return qstrcmp(s1 ? s1 : "",s2 ? s2 : "")==0;
+}
+
+/** Copies the strings of \a src so the result does not share data with it */
+static inline void copyInfo(LookupInfo &dst,const LookupInfo &src)
+{
+  dst.classDef     = src.classDef;
+  dst.typeDef      = src.typeDef;
+  dst.templSpec    = QCString(src.templSpec.data());
+  dst.resolvedType = QCString(src.resolvedType.data());
+}
+
+LookupKey::LookupKey(const Definition *s,const FileDef *fs,const char *n,const char *es)
+  : scope(s), fileScope(fs), name(n ? n : ""), explicitScope(es ? es : "")
+{
+  uint h = 2166136261U;
+  h = hashBytes(h,(const char *)&scope,sizeof(scope));
+  h = hashBytes(h,(const char *)&fileScope,sizeof(fileScope));
+  h = hashString(h,name);
+  h = hashString(h,explicitScope);
+  hash = h;
+}
+
+//----------------------------------------------------------------------------
+
+struct LookupCache::Node
+{
+  Node() : used(FALSE), hash(0), scope(0), fileScope(0) {}
+  bool              used;
+  uint              hash;
+  const Definition *scope;
+  const FileDef    *fileScope;
+  QCString          name;
+  QCString          explicitScope;
+  LookupInfo        info;
+};
+
+struct LookupCache::Shard
+{
+  Shard() : nodes(0), capacity(0), maxCapacity(0), count(0),
+            hits(0), misses(0), evictions(0) {}
+  QMutex mutex;
+  Node  *nodes;
+  uint   capacity;     // always a power of two
+  uint   maxCapacity;
+  uint   count;
+  uint   hits;
+  uint   misses;
+  uint   evictions;
+};
+
+LookupCache::LookupCache(uint maxSize) : m_maxSize(maxSize)
+{
+  uint maxCapacity = 1;
+  while (maxCapacity*NumShards<maxSize) maxCapacity<<=1;
+  m_shards = new Shard[NumShards];
+  int i;
+  for (i=0;i<NumShards;i++)
+  {
+    Shard &s = m_shards[i];
+    s.maxCapacity = maxCapacity;
+    s.capacity    = QMIN(INITIAL_SHARD_SIZE,maxCapacity);
+    s.nodes       = new Node[s.capacity];
+  }
+}
+
+LookupCache::~LookupCache()
+{
+  int i;
+  for (i=0;i<NumShards;i++)
+  {
+    delete[] m_shards[i].nodes;
+  }
+  delete[] m_shards;
+}
+
+LookupCache::Node *LookupCache::findNode(Shard &s,const LookupKey &key)
+{
+  // linear probing; the lowest bits of the hash select the shard
+  uint mask = s.capacity-1;
+  uint index = (key.hash/NumShards) & mask;
+  for (;;)
+  {
+    Node *n = &s.nodes[index];
+    if (!n->used) return n;
+    if (n->hash==key.hash &&
+        n->scope==key.scope &&
+        n->fileScope==key.fileScope &&
+        stringsEqual(n->name.data(),key.name) &&
+        stringsEqual(n->explicitScope.data(),key.explicitScope))
+    {
+      return n;
+    }
+    index = (index+1) & mask;
+  }
+}
+
+void LookupCache::resize(Shard &s,uint capacity)
+{
+  Node *oldNodes = s.nodes;
+  uint oldCapacity = s.capacity;
+  s.nodes    = new Node[capacity];
+  s.capacity = capacity;
+  uint mask  = capacity-1;
+  uint i;
+  for (i=0;i<oldCapacity;i++)
+  {
+    Node &o = oldNodes[i];
+    if (o.used)
+    {
+      uint index = (o.hash/NumShards) & mask;
+      while (s.nodes[index].used) index = (index+1) & mask;
+      Node &n = s.nodes[index];
+      n.used          = TRUE;
+      n.hash          = o.hash;
+      n.scope         = o.scope;
+      n.fileScope     = o.fileScope;
+      n.name          = o.name;
+      n.explicitScope = o.explicitScope;
+      n.info          = o.info;
+    }
+  }
+  delete[] oldNodes;
+}
+
+bool LookupCache::find(const LookupKey &key,LookupInfo &info)
+{
+  Shard &s = m_shards[key.hash%NumShards];
+  QMutexLocker lock(&s.mutex);
+  Node *n = findNode(s,key);
+  if (n->used)
+  {
+    s.hits++;
+    copyInfo(info,n->info);
+    return TRUE;
+  }
+  s.misses++;
+  return FALSE;
+}
+
+void LookupCache::insert(const LookupKey &key,const LookupInfo &info)
+{
+  Shard &s = m_shards[key.hash%NumShards];
+  QMutexLocker lock(&s.mutex);
+  Node *n = findNode(s,key);
+  if (!n->used)
+  {
+    if ((s.count+1)*4>s.capacity*3) // keep the load factor below 3/4
+    {
+      if (s.capacity<s.maxCapacity)
+      {
+        resize(s,s.capacity*2);
+      }
+      else // shard is full, start over
+      {
+        delete[] s.nodes;
+        s.nodes = new Node[s.capacity];
+        s.count = 0;
+        s.evictions++;
+      }
+      n = findNode(s,key);
+    }
+    n->used          = TRUE;
+    n->hash          = key.hash;
+    n->scope         = key.scope;
+    n->fileScope     = key.fileScope;
+    n->name          = key.name;
+    n->explicitScope = key.explicitScope;
+    s.count++;
+  }
+  copyInfo(n->info,info);
+}
+
+void LookupCache::remove(bool (*filter)(const LookupInfo &info))
+{
+  int i;
+  for (i=0;i<NumShards;i++)
+  {
+    Shard &s = m_shards[i];
+    QMutexLocker lock(&s.mutex);
+    uint j,removed=0;
+    for (j=0;j<s.capacity;j++)
+    {
+      Node &n = s.nodes[j];
+      if (n.used && filter(n.info))
+      {
+        n.used = FALSE;
+        removed++;
+      }
+    }
+    if (removed>0)
+    {
+      s.count-=removed;
+      resize(s,s.capacity); // rehash to close the gaps in the probe sequences
+    }
+  }
+}
+
+void LookupCache::clear()
+{
+  int i;
+  for (i=0;i<NumShards;i++)
+  {
+    Shard &s = m_shards[i];
+    QMutexLocker lock(&s.mutex);
+    delete[] s.nodes;
+    s.nodes = new Node[s.capacity];
+    s.count = 0;
+  }
+}
+
+uint LookupCache::count() const
+{
+  uint result=0;
+  int i;
+  for (i=0;i<NumShards;i++) result+=m_shards[i].count;
+  return result;
+}
+
+uint LookupCache::hits() const
+{
+  uint result=0;
+  int i;
+  for (i=0;i<NumShards;i++) result+=m_shards[i].hits;
+  return result;
+}
+
+uint LookupCache::misses() const
+{
+  uint result=0;
+  int i;
+  for (i=0;i<NumShards;i++) result+=m_shards[i].misses;
+  return result;
+}
+
+void LookupCache::printStats()
+{
+  msg("lookup cache used %d/%d hits=%d misses=%d\n",
+      count(),size(),hits(),misses());
+  int i;
+  for (i=0;i<NumShards;i++)
+  {
+    Shard &s = m_shards[i];
+    msg("  shard %2d: used %d/%d hits=%d misses=%d evictions=%d\n",
+        i,s.count,s.capacity,s.hits,s.misses,s.evictions);
+  }
+}
@@ -0,0 +1,102 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef LOOKUPCACHE_H
+#define LOOKUPCACHE_H
+
+#include <qcstring.h>
+
+class Definition;
+class FileDef;
+class QMutex;
+struct LookupInfo;
+
+/** @brief Key for the LookupCache.
+ *
+ *  The key is formed by the scope in which a name is searched, the file
+ *  scope (only relevant if the file has using statements), the name
+ *  itself and its explicit scope prefix. The hash value is computed once
+ *  when the key is constructed. The key does not copy the strings, so it
+ *  should not outlive them.
+ */
+struct LookupKey
+{
+  LookupKey(const Definition *s,const FileDef *fs,const char *n,const char *es);
+  const Definition *scope;
+  const FileDef    *fileScope;
+  const char       *name;
+  const char       *explicitScope;
+  uint              hash;
+};
+
+/** @brief Cache for the results of getResolvedClass().
+ *
+ *  The cache is divided into a fixed number of shards, each having its
+ *  own lock and open addressing hash table, so that lookups from different
+ *  threads only contend if they map onto the same shard. A shard grows
+ *  until it reaches its share of the maximum size; when it is full after
+ *  that, its contents are discarded.
+ *
+ *  Results are copied in and out of the cache, so no references to the
+ *  data stored in the cache are handed out.
+ */
+class LookupCache
+{
+  public:
+    /*! Creates the cache. The maximum number of elements is \a maxSize. */
+    LookupCache(uint maxSize);
+   ~LookupCache();
+
+    /*! Looks up \a key. If found the cached result is copied into
+     *  \a info and TRUE is returned.
+     */
+    bool find(const LookupKey &key,LookupInfo &info);
+
+    /*! Stores \a info for \a key, replacing any previous result. */
+    void insert(const LookupKey &key,const LookupInfo &info);
+
+    /*! Removes all elements for which \a filter returns TRUE. */
+    void remove(bool (*filter)(const LookupInfo &info));
+
+    /*! Removes all elements from the cache. */
+    void clear();
+
+    /*! Prints the hit/miss statistics for each shard. */
+    void printStats();
+
+    /*! Maximum number of elements in the cache */
+    uint size() const { return m_maxSize; }
+
+    /*! Number of elements in the cache */
+    uint count() const;
+
+    /*! Total number of hits over all shards */
+    uint hits() const;
+
+    /*! Total number of misses over all shards */
+    uint misses() const;
+
+  private:
+    struct Node;
+    struct Shard;
+    static const int NumShards = 16;
+    static Node *findNode(Shard &s,const LookupKey &key);
+    static void resize(Shard &s,uint capacity);
+
+    Shard *m_shards;
+    uint   m_maxSize;
+};
+
+#endif
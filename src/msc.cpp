@@ -23,10 +23,10 @@
 #include "doxygen.h"
 #include "util.h"
 #include "ftextstream.h"
+#include "diagramjobs.h"
 
 #include <qdir.h>
-
-static const int maxCmdLine = 40960;
+#include <qfileinfo.h>
 
 static bool convertMapFile(FTextStream &t,const char *mapName,const QCString relPath,
                            const QCString &context)
@@ -96,11 +96,6 @@ void writeMscGraphFromFile(const char *inFile,const char *outDir,
   absOutFile+=portable_pathSeparator();
   absOutFile+=outFile;
 
-  // chdir to the output dir, so dot can find the font file.
-  QCString oldDir = QDir::currentDirPath().utf8();
-  // go to the html output directory (i.e. path)
-  QDir::setCurrent(outDir);
-  //printf("Going to dir %s\n",QDir::currentDirPath().data());
   QCString mscExe = Config_getString("MSCGEN_PATH")+"mscgen"+portable_commandExtension();
   QCString mscArgs;
   QCString extension;
@@ -119,56 +114,52 @@ void writeMscGraphFromFile(const char *inFile,const char *outDir,
       extension=".svg";
       break;
     default:
-      goto error; // I am not very fond of goto statements, but when in Rome...
+      return;
   }
-  mscArgs+=" -i \"";
-  mscArgs+=inFile;
- 
-  mscArgs+="\" -o \"";
-  mscArgs+=outFile;
-  mscArgs+=extension+"\"";
-  int exitCode;
-//  printf("*** running: %s %s outDir:%s %s\n",mscExe.data(),mscArgs.data(),outDir,outFile);
-  portable_sysTimerStart();
-  if ((exitCode=portable_system(mscExe,mscArgs,FALSE))!=0)
+  // the same file may be used more than once, it only needs one job
+  if (DiagramJobManager::instance()->isScheduled(absOutFile)) return;
+  // skip running mscgen if the input did not change since the previous run
+  static bool usePdfLatex = Config_getBool("USE_PDFLATEX");
+  if (!checkAndUpdateMd5Signature(absOutFile,fileSignature(inFile,mscArgs)) &&
+      QFileInfo(absOutFile+extension).exists() &&
+      (format!=MSC_EPS || !usePdfLatex || QFileInfo(absOutFile+".pdf").exists())
+     )
   {
-    portable_sysTimerStop();
-    goto error;
+    return;
   }
-  portable_sysTimerStop();
-  if ( (format==MSC_EPS) && (Config_getBool("USE_PDFLATEX")) )
+  // mscgen runs in the background, so it works on a copy of the input, 
+  // which may be a temporary file.
+  QCString srcFile = absOutFile+"_src.msc";
+  if (!copyFile(inFile,srcFile))
   {
-    QCString epstopdfArgs(maxCmdLine);
-    epstopdfArgs.sprintf("\"%s.eps\" --outfile=\"%s.pdf\"",
-                         outFile,outFile);
-    portable_sysTimerStart();
-    if (portable_system("epstopdf",epstopdfArgs)!=0)
-    {
-      err("Problems running epstopdf. Check your TeX installation!\n");
-    }
-    portable_sysTimerStop();
+    return;
   }
-
-error:
-  QDir::setCurrent(oldDir);
+  mscArgs+=" -i \"";
+  mscArgs+=srcFile;
+ 
+  mscArgs+="\" -o \"";
+  mscArgs+=absOutFile;
+  mscArgs+=extension+"\"";
+  //printf("*** running: %s %s outDir:%s %s\n",mscExe.data(),mscArgs.data(),outDir,outFile);
+  DiagramJob *job = new DiagramJob(mscExe,mscArgs,FALSE,
+                                   "Problems running mscgen. Check your installation!");
+  job->addTempFile(srcFile);
+  if (format==MSC_EPS) job->addEpsFile(absOutFile);
+  DiagramJobManager::instance()->addJob(job,absOutFile);
 }
 
 QCString getMscImageMapFromFile(const QCString& inFile, const QCString& outDir,
                                 const QCString& relPath,const QCString& context)
 {
-  QCString outFile = inFile + ".map";
-
+  // use absolute paths instead of changing the current directory, as the
+  // diagram tools may be running in the background
+  QCString absInFile = QDir(outDir).absFilePath(inFile).utf8();
+  QCString outFile = absInFile + ".map";
 
   //printf("*** running:getMscImageMapFromFile \n");
-  // chdir to the output dir, so dot can find the font file.
-  QCString oldDir = QDir::currentDirPath().utf8();
-  // go to the html output directory (i.e. path)
-  QDir::setCurrent(outDir);
-  //printf("Going to dir %s\n",QDir::currentDirPath().data());
-
   QCString mscExe = Config_getString("MSCGEN_PATH")+"mscgen"+portable_commandExtension();
   QCString mscArgs = "-T ismap -i \"";
-  mscArgs+=inFile;
+  mscArgs+=absInFile;
   mscArgs+="\" -o \"";
   mscArgs+=outFile + "\"";
 
@@ -177,7 +168,6 @@ QCString getMscImageMapFromFile(const QCString& inFile, const QCString& outDir,
   if ((exitCode=portable_system(mscExe,mscArgs,FALSE))!=0)
   {
     portable_sysTimerStop();
-    QDir::setCurrent(oldDir);
     return "";
   }
   portable_sysTimerStop();
@@ -187,7 +177,6 @@ QCString getMscImageMapFromFile(const QCString& inFile, const QCString& outDir,
   convertMapFile(tmpout, outFile, relPath, context);
   QDir().remove(outFile);
 
-  QDir::setCurrent(oldDir);
   return result.data();
 }
 
@@ -18,11 +18,18 @@
 #include <stdlib.h>
 
 #include <qfile.h>
+#include <qbuffer.h>
+#include <qqueue.h>
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
 
 #include "outputgen.h"
 #include "message.h"
 #include "portable.h"
 
+int OutputGenerator::numPlainFiles=0;
+
 OutputGenerator::OutputGenerator()
 {
   //printf("OutputGenerator::OutputGenerator()\n");
@@ -43,11 +50,21 @@ void OutputGenerator::startPlainFile(const char *name)
 {
   //printf("startPlainFile(%s)\n",name);
   fileName=dir+"/"+name;
-  file = new QFile(fileName);
-  if (!file->open(IO_WriteOnly))
+  numPlainFiles++;
+  if (OutputFileWriter::isActive())
+  {
+    // collect the page in memory, it is written by endPlainFile()
+    file = new QBuffer;
+    file->open(IO_WriteOnly);
+  }
+  else
   {
-    err("Could not open file %s for writing\n",fileName.data());
-    exit(1);
+    file = new QFile(fileName);
+    if (!file->open(IO_WriteOnly))
+    {
+      err("Could not open file %s for writing\n",fileName.data());
+      exit(1);
+    }
   }
   t.setDevice(file);
 }
@@ -55,7 +72,14 @@ void OutputGenerator::startPlainFile(const char *name)
 void OutputGenerator::endPlainFile()
 {
   t.unsetDevice();
-  delete file;
+  if (OutputFileWriter::isActive())
+  {
+    OutputFileWriter::enqueue(fileName,(QBuffer*)file);
+  }
+  else
+  {
+    delete file;
+  }
   file=0;
   fileName.resize(0);
 }
@@ -76,3 +100,123 @@ void OutputGenerator::popGeneratorState()
   delete lb;
 }
 
+
+//--------------------------------------------------------------------
+
+/** A page that is waiting to be written to disk. */
+struct OutputFileJob
+{
+  OutputFileJob(const QCString &fn,QBuffer *b) : fileName(fn.data()), buf(b) {}
+ ~OutputFileJob() { delete buf; }
+  QCString fileName;
+  QBuffer *buf;
+};
+
+/** Worker thread of the OutputFileWriter, with its own queue of pages. */
+class OutputFileWriterThread : public QThread
+{
+  public:
+    OutputFileWriterThread() : m_failed(FALSE) {}
+    void enqueue(OutputFileJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      // limit the amount of memory used by pages that are not yet written
+      while (m_queue.count()>=maxPending)
+      {
+        m_queueNotFull.wait(&m_mutex);
+      }
+      m_queue.enqueue(job);
+      m_queueNotEmpty.wakeAll();
+    }
+    bool failed() const { return m_failed; }
+    void run()
+    {
+      OutputFileJob *job;
+      while ((job=dequeue()))
+      {
+        QFile f(job->fileName);
+        if (!f.open(IO_WriteOnly))
+        {
+          err("Could not open file %s for writing\n",job->fileName.data());
+          m_failed=TRUE;
+        }
+        else
+        {
+          QByteArray data = job->buf->buffer();
+          if (f.writeBlock(data.data(),data.size())!=(int)data.size())
+          {
+            err("Problems writing file %s\n",job->fileName.data());
+            m_failed=TRUE;
+          }
+        }
+        delete job;
+      }
+    }
+  private:
+    OutputFileJob *dequeue()
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.isEmpty())
+      {
+        m_queueNotEmpty.wait(&m_mutex);
+      }
+      OutputFileJob *job = m_queue.dequeue();
+      m_queueNotFull.wakeAll();
+      return job;
+    }
+    static const uint maxPending = 64;
+    QQueue<OutputFileJob> m_queue;
+    QMutex          m_mutex;
+    QWaitCondition  m_queueNotEmpty;
+    QWaitCondition  m_queueNotFull;
+    bool            m_failed;
+};
+
+QList<OutputFileWriterThread> OutputFileWriter::m_workers;
+
+void OutputFileWriter::start(int numThreads)
+{
+  int i;
+  for (i=0;i<numThreads;i++)
+  {
+    OutputFileWriterThread *thread = new OutputFileWriterThread;
+    thread->start();
+    if (thread->isRunning())
+    {
+      m_workers.append(thread);
+    }
+    else // no more threads available!
+    {
+      delete thread;
+    }
+  }
+}
+
+void OutputFileWriter::stop()
+{
+  bool failed=FALSE;
+  QListIterator<OutputFileWriterThread> it(m_workers);
+  OutputFileWriterThread *thread;
+  for (;(thread=it.current());++it)
+  {
+    thread->enqueue(0); // terminator
+  }
+  for (it.toFirst();(thread=it.current());++it)
+  {
+    thread->wait();
+    failed = failed || thread->failed();
+    delete thread;
+  }
+  m_workers.clear();
+  if (failed) exit(1);
+}
+
+void OutputFileWriter::enqueue(const QCString &fileName,QBuffer *buf)
+{
+  // pick a thread based on the name, so that pages with the same name
+  // are written in order
+  uint h=0;
+  const char *p=fileName.data();
+  while (*p) h = h*31+(uchar)*p++;
+  m_workers.at(h%m_workers.count())->enqueue(new OutputFileJob(fileName,buf));
+}
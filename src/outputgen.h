@@ -36,6 +36,9 @@ class MemberDef;
 class GroupDef;
 class Definition;
 class QFile;
+class QIODevice;
+class QBuffer;
+class OutputFileWriterThread;
 
 struct DocLinkInfo
 {
@@ -337,6 +340,7 @@ class OutputGenerator : public BaseOutputDocInterface
     virtual OutputGenerator *get(OutputType o) = 0;
     void startPlainFile(const char *name);
     void endPlainFile();
+    static int numPlainFiles; //!< counts the files started by startPlainFile()
     //QCString getContents() const;
     bool isEnabled() const { return active; }
     void pushGeneratorState();
@@ -484,7 +488,7 @@ class OutputGenerator : public BaseOutputDocInterface
 
   protected:
     FTextStream t;
-    QFile *file;
+    QIODevice *file;
     QCString fileName;
     QCString dir;
     bool active;
@@ -554,4 +558,29 @@ class OutputDocInterface : public BaseOutputDocInterface
 };
 
 
+/** Writes the files produced by the output generators to disk on a
+ *  pool of worker threads, so that creating and writing a page overlaps
+ *  with generating the next one. Pages with the same name are always
+ *  written by the same thread, so they are written in the order in which
+ *  they were produced.
+ */
+class OutputFileWriter
+{
+  public:
+    /** Starts \a numThreads writer threads. Until stop() is called,
+     *  OutputGenerator::startPlainFile() collects each page in memory.
+     */
+    static void start(int numThreads);
+    /** Waits until all queued pages are written and stops the threads. */
+    static void stop();
+    static bool isActive() { return !m_workers.isEmpty(); }
+    /** Queues \a buf to be written to \a fileName. Takes ownership of
+     *  \a buf.
+     */
+    static void enqueue(const QCString &fileName,QBuffer *buf);
+
+  private:
+    static QList<OutputFileWriterThread> m_workers;
+};
+
 #endif
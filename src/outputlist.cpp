@@ -28,6 +28,7 @@
 #include "message.h"
 #include "definition.h"
 #include "docparser.h"
+#include "doccache.h"
 #include "vhdldocgen.h"
 
 OutputList::OutputList(bool)
@@ -146,7 +147,7 @@ bool OutputList::generateDoc(const char *fileName,int startLine,
   if (count==0) return TRUE; // no output formats enabled.
 
   DocRoot *root=0;
-  root = validatingParseDoc(fileName,startLine,
+  root = DocCache::instance()->parse(fileName,startLine,
                             ctx,md,docStr,indexWords,isExample,exampleName,
                             singleLine,linkFromIndex);
 
@@ -154,7 +155,7 @@ bool OutputList::generateDoc(const char *fileName,int startLine,
 
   bool isEmpty = root->isEmpty();
 
-  delete root;
+  DocCache::instance()->release(root);
 
   return isEmpty;
 }
@@ -0,0 +1,286 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include <qdir.h>
+#include <qfileinfo.h>
+#include <qgstring.h>
+
+#include "md5.h"
+
+#include "parsecache.h"
+#include "config.h"
+#include "doxygen.h"
+#include "entry.h"
+#include "filestorage.h"
+#include "ftextstream.h"
+#include "marshal.h"
+#include "message.h"
+#include "reflist.h"
+#include "section.h"
+#include "formula.h"
+#include "membergroup.h"
+#include "version.h"
+
+#define CACHE_MAGIC 0xD0C5CAC1
+
+ParseCache *ParseCache::s_instance = 0;
+
+ParseCache *ParseCache::instance()
+{
+  if (s_instance==0)
+  {
+    s_instance = new ParseCache;
+  }
+  return s_instance;
+}
+
+void ParseCache::deleteInstance()
+{
+  delete s_instance;
+  s_instance=0;
+}
+
+ParseCache::ParseCache() : m_usedKeys(10007), m_hits(0), m_misses(0), m_stored(0)
+{
+  QCString dir = Config_getString("PARSE_CACHE_DIRECTORY");
+  if (dir.isEmpty()) return;
+
+  QDir d(dir);
+  if (!d.exists() && !d.mkdir(dir))
+  {
+    err("Could not create parse cache directory %s, parse cache disabled\n",dir.data());
+    return;
+  }
+  m_dir = dir;
+
+  // options that do not influence the parse result should not invalidate the cache
+  static const char *ignoredOptions[] =
+  {
+    "PROJECT_NUMBER", "PROJECT_BRIEF", "PROJECT_LOGO",
+    "PARSE_CACHE_DIRECTORY", "NUM_PROC_THREADS", 0
+  };
+  QGString config;
+  {
+    FTextStream t(&config);
+    t << versionString << "\n";
+    QListIterator<ConfigOption> it = Config::instance()->iterator();
+    ConfigOption *option;
+    for (;(option=it.current());++it)
+    {
+      bool ignore=FALSE;
+      const char **p;
+      for (p=ignoredOptions;*p && !ignore;p++)
+      {
+        ignore = option->name()==*p;
+      }
+      if (ignore) continue;
+      switch (option->kind())
+      {
+        case ConfigOption::O_List:
+          {
+            t << option->name() << "=";
+            const char *item;
+            QStrListIterator li(*((ConfigList *)option)->valueRef());
+            for (;(item=li.current());++li) t << item << "\n";
+          }
+          break;
+        case ConfigOption::O_Enum:
+          t << option->name() << "=" << *((ConfigEnum *)option)->valueRef() << "\n";
+          break;
+        case ConfigOption::O_String:
+          t << option->name() << "=" << *((ConfigString *)option)->valueRef() << "\n";
+          break;
+        case ConfigOption::O_Int:
+          t << option->name() << "=" << *((ConfigInt *)option)->valueRef() << "\n";
+          break;
+        case ConfigOption::O_Bool:
+          t << option->name() << "=" << (*((ConfigBool *)option)->valueRef() ? "YES" : "NO") << "\n";
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  uchar md5_sig[16];
+  m_configSignature.resize(33);
+  MD5Buffer((const unsigned char *)config.data(),config.length(),md5_sig);
+  MD5SigToString(md5_sig,m_configSignature.rawData(),33);
+}
+
+QCString ParseCache::computeKey(const char *fileName,const char *data,uint len) const
+{
+  struct MD5Context ctx;
+  MD5Init(&ctx);
+  MD5Update(&ctx,(const unsigned char *)m_configSignature.data(),m_configSignature.length());
+  MD5Update(&ctx,(const unsigned char *)fileName,qstrlen(fileName)+1);
+  MD5Update(&ctx,(const unsigned char *)data,len);
+  uchar md5_sig[16];
+  MD5Final(md5_sig,&ctx);
+  QCString key(33);
+  MD5SigToString(md5_sig,key.rawData(),33);
+  return key;
+}
+
+QCString ParseCache::cacheFileName(const QCString &key) const
+{
+  return m_dir+"/"+key+".entries";
+}
+
+Entry *ParseCache::load(const QCString &key,const char *fileName)
+{
+  m_usedKeys.insert(key,(void*)0x8);
+  QCString cacheFile = cacheFileName(key);
+  if (!QFileInfo(cacheFile).exists())
+  {
+    m_misses++;
+    return 0;
+  }
+  FileStorage f(cacheFile);
+  if (!f.open(IO_ReadOnly))
+  {
+    m_misses++;
+    return 0;
+  }
+  Entry *root=0;
+  if (unmarshalUInt(&f)==CACHE_MAGIC && unmarshalQCString(&f)==fileName)
+  {
+    root = unmarshalEntryTree(&f);
+    if (unmarshalUInt(&f)!=CACHE_MAGIC) // truncated or corrupt
+    {
+      delete root;
+      root=0;
+    }
+  }
+  f.close();
+  if (root)
+  {
+    msg("Using cached entries for %s...\n",fileName);
+    m_hits++;
+  }
+  else
+  {
+    m_misses++;
+  }
+  return root;
+}
+
+void ParseCache::getGlobalState(GlobalState &state)
+{
+  state.sections         = Doxygen::sectionDict->count();
+  state.formulas         = Doxygen::formulaList->count();
+  state.memberGroups     = Doxygen::memGrpInfoDict.count();
+  state.namespaceAliases = Doxygen::namespaceAliasDict.count();
+  state.xrefLists        = Doxygen::xrefLists->count();
+}
+
+void ParseCache::startParse()
+{
+  getGlobalState(m_state);
+}
+
+static bool hasCitation(const QCString &doc)
+{
+  return doc.find("\\cite")!=-1 || doc.find("@cite")!=-1;
+}
+
+/** Returns TRUE if \a doc refers to a formula by its number. The number
+ *  depends on the formulas found in the files parsed before.
+ */
+static bool hasFormula(const QCString &doc)
+{
+  return doc.find("\\form#")!=-1;
+}
+
+bool ParseCache::isPure(Entry *root) const
+{
+  // xref items, member groups, anonymous scopes, citations and formulas
+  // are numbered or registered globally while parsing
+  if (root->sli && root->sli->count()>0) return FALSE;
+  if (root->mGrpId!=DOX_NOGROUP) return FALSE;
+  if (root->name.find('@')!=-1) return FALSE;
+  if (hasCitation(root->doc) || hasCitation(root->brief) ||
+      hasCitation(root->inbodyDocs)) return FALSE;
+  if (hasFormula(root->doc) || hasFormula(root->brief) ||
+      hasFormula(root->inbodyDocs)) return FALSE;
+  QListIterator<Entry> eli(*root->children());
+  Entry *child;
+  for (;(child=eli.current());++eli)
+  {
+    if (!isPure(child)) return FALSE;
+  }
+  return TRUE;
+}
+
+void ParseCache::store(const QCString &key,const char *fileName,Entry *root)
+{
+  GlobalState state;
+  getGlobalState(state);
+  if (state.sections         != m_state.sections         ||
+      state.formulas         != m_state.formulas         ||
+      state.memberGroups     != m_state.memberGroups     ||
+      state.namespaceAliases != m_state.namespaceAliases ||
+      state.xrefLists        != m_state.xrefLists        ||
+      !isPure(root))
+  {
+    return;
+  }
+
+  // write to a temporary file first, so an interrupted run cannot leave
+  // a partial entry behind
+  QCString cacheFile = cacheFileName(key);
+  QCString tmpFile = cacheFile+".tmp";
+  FileStorage f(tmpFile);
+  if (!f.open(IO_WriteOnly))
+  {
+    err("Could not write parse cache file %s\n",tmpFile.data());
+    return;
+  }
+  marshalUInt(&f,CACHE_MAGIC);
+  marshalQCString(&f,fileName);
+  marshalEntryTree(&f,root);
+  marshalUInt(&f,CACHE_MAGIC);
+  f.close();
+  QDir thisDir;
+  thisDir.remove(cacheFile);
+  if (thisDir.rename(tmpFile,cacheFile))
+  {
+    m_stored++;
+  }
+}
+
+void ParseCache::finish()
+{
+  if (!isEnabled() || m_hits+m_misses==0) return;
+  msg("Parse cache: %d files loaded from cache, %d files parsed, %d files stored\n",
+      m_hits,m_misses,m_stored);
+
+  QDir dir(m_dir);
+  dir.setFilter(QDir::Files);
+  dir.setNameFilter("*.entries");
+  const QFileInfoList *list = dir.entryInfoList();
+  if (list)
+  {
+    QFileInfoListIterator it(*list);
+    QFileInfo *fi;
+    for (;(fi=it.current());++it)
+    {
+      QCString key = fi->baseName().utf8();
+      if (m_usedKeys.find(key)==0) // stale entry
+      {
+        dir.remove(fi->fileName());
+      }
+    }
+  }
+}
@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <qcstring.h>
+#include <qdict.h>
+
+class Entry;
+
+/** @brief Persistent cache for the Entry trees produced by the parsers.
+ *
+ *  The Entry tree of an input file is stored in the directory set by
+ *  PARSE_CACHE_DIRECTORY, using the MD5 of the configuration, the file name
+ *  and the preprocessed file contents as the key. When a file with the same
+ *  key is found in a later run, its Entry tree is loaded from the cache
+ *  instead of parsing the file again.
+ *
+ *  Parsing a file may also add sections, formulas, xref items and the like
+ *  to global dictionaries. Files for which this happens are not stored, so
+ *  only parse results that are fully described by their Entry tree are
+ *  reused.
+ */
+class ParseCache
+{
+  public:
+    static ParseCache *instance();
+    static void deleteInstance();
+
+    /** Returns TRUE if a cache directory is configured. */
+    bool isEnabled() const { return !m_dir.isEmpty(); }
+
+    /** Returns the cache key for file \a fileName with preprocessed
+     *  contents \a data of \a len bytes.
+     */
+    QCString computeKey(const char *fileName,const char *data,uint len) const;
+
+    /** Returns the Entry tree stored for \a key, or 0 if there is none.
+     *  The caller takes ownership of the tree.
+     */
+    Entry *load(const QCString &key,const char *fileName);
+
+    /** Marks the start of parsing a file that may be stored in the cache. */
+    void startParse();
+
+    /** Stores the Entry tree \a root parsed from \a fileName under \a key,
+     *  unless the parser changed global state since startParse() was called.
+     */
+    void store(const QCString &key,const char *fileName,Entry *root);
+
+    /** Removes the entries that were not used in this run from the cache
+     *  directory and reports the cache statistics.
+     */
+    void finish();
+
+  private:
+    ParseCache();
+    QCString cacheFileName(const QCString &key) const;
+    bool isPure(Entry *root) const;
+
+    struct GlobalState
+    {
+      uint sections;
+      uint formulas;
+      uint memberGroups;
+      uint namespaceAliases;
+      uint xrefLists;
+    };
+    static void getGlobalState(GlobalState &state);
+
+    static ParseCache *s_instance;
+    QCString    m_dir;
+    QCString    m_configSignature;
+    GlobalState m_state;
+    QDict<void> m_usedKeys;
+    int         m_hits;
+    int         m_misses;
+    int         m_stored;
+};
+
+#endif
@@ -17,8 +17,11 @@
 #include "portable.h"
 #include "config.h"
 #include "message.h"
+#include "util.h"
+#include "diagramjobs.h"
 
 #include <qdir.h>
+#include <qfileinfo.h>
 
 static const int maxCmdLine = 40960;
 
@@ -53,74 +56,171 @@ QCString writePlantUMLSource(const QCString &outDir,const QCString &fileName,con
 
 void generatePlantUMLOutput(const char *baseName,const char *outDir,PlantUMLOutputFormat format)
 {
-  static QCString plantumlJarPath = Config_getString("PLANTUML_JAR_PATH");
-
-  QCString pumlExe = "java";
-  QCString pumlArgs = "";
-
-  QStrList &pumlIncludePathList = Config_getList("PLANTUML_INCLUDE_PATH");
-  char *s=pumlIncludePathList.first();
-  if (s)
-  {
-    pumlArgs += "-Dplantuml.include.path=\"";
-    pumlArgs += s;
-    s = pumlIncludePathList.next(); 
-  }
-  while (s)
-  {
-    pumlArgs += portable_pathListSeparator();
-    pumlArgs += s;
-    s = pumlIncludePathList.next(); 
-  }
-  if (pumlIncludePathList.first()) pumlArgs += "\" ";
-  pumlArgs += "-Djava.awt.headless=true -jar \""+plantumlJarPath+"plantuml.jar\" ";
-  pumlArgs+="-o \"";
-  pumlArgs+=outDir;
-  pumlArgs+="\" ";
   QCString extension;
   switch (format)
   {
     case PUML_BITMAP:
-      pumlArgs+="-tpng";
       extension=".png";
       break;
     case PUML_EPS:
-      pumlArgs+="-teps";
       extension=".eps";
       break;
     case PUML_SVG:
-      pumlArgs+="-tsvg";
       extension=".svg";
       break;
   }
-  pumlArgs+=" \"";
-  pumlArgs+=baseName;
-  pumlArgs+=".pu\" ";
-  pumlArgs+="-charset UTF-8 ";
-  int exitCode;
-  //printf("*** running: %s %s outDir:%s %s\n",pumlExe.data(),pumlArgs.data(),outDir,outFile);
-  msg("Running PlantUML on generated file %s.pu\n",baseName);
-  portable_sysTimerStart();
-  if ((exitCode=portable_system(pumlExe,pumlArgs,TRUE))!=0)
+  QCString puFile = QCString(baseName)+".pu";
+  // skip running PlantUML if the source and the output format did not 
+  // change since the previous run
+  static bool usePdfLatex = Config_getBool("USE_PDFLATEX");
+  QCString imgName = QCString(outDir)+"/"+stripPath(baseName)+extension;
+  QCString pdfName = QCString(baseName)+".pdf"; // produced from the .eps by epstopdf
+  QCString sigStr = fileSignature(puFile,extension);
+  if (!checkAndUpdateMd5Signature(baseName,sigStr) && QFileInfo(imgName).exists() &&
+      (format!=PUML_EPS || !usePdfLatex || QFileInfo(pdfName).exists())
+     )
+  {
+    if (Config_getBool("DOT_CLEANUP")) QFile(puFile).remove();
+    return;
+  }
+  PlantumlManager::instance()->insert(baseName,outDir,format);
+}
+
+//--------------------------------------------------------------------
+
+/** The PlantUML files that are converted to the same format in the same
+ *  output directory.
+ */
+struct PlantumlManager::Group
+{
+  Group(const char *dir,PlantUMLOutputFormat f) : outDir(dir), format(f), fileDict(257) {}
+  QCString             outDir;
+  PlantUMLOutputFormat format;
+  QStrList             files;
+  QDict<void>          fileDict;
+};
+
+PlantumlManager *PlantumlManager::m_theInstance = 0;
+
+PlantumlManager *PlantumlManager::instance()
+{
+  if (!m_theInstance)
+  {
+    m_theInstance = new PlantumlManager;
+  }
+  return m_theInstance;
+}
+
+PlantumlManager::PlantumlManager()
+{
+  m_groups.setAutoDelete(TRUE);
+}
+
+void PlantumlManager::insert(const char *baseName,const char *outDir,PlantUMLOutputFormat format)
+{
+  QListIterator<Group> gli(m_groups);
+  Group *group;
+  for (;(group=gli.current());++gli)
+  {
+    if (group->format==format && group->outDir==outDir) break;
+  }
+  if (group==0)
+  {
+    group = new Group(outDir,format);
+    m_groups.append(group);
+  }
+  if (group->fileDict.find(baseName)==0)
+  {
+    group->fileDict.insert(baseName,(void*)0x8);
+    group->files.append(baseName);
+  }
+}
+
+/*! Adds a job to the DiagramJobManager for the files of each group,
+ *  so a single instance of PlantUML converts them.
+ */
+void PlantumlManager::run()
+{
+  static QCString plantumlJarPath = Config_getString("PLANTUML_JAR_PATH");
+  static bool dotCleanUp = Config_getBool("DOT_CLEANUP");
+
+  QCString pumlExe = "java";
+  QCString pumlCommonArgs = "";
+
+  // the include paths are made absolute, as PlantUML runs in the background
+  // while the current directory may change
+  QStrList &pumlIncludePathList = Config_getList("PLANTUML_INCLUDE_PATH");
+  char *s=pumlIncludePathList.first();
+  if (s)
   {
-    err("Problems running PlantUML. Verify that the command 'java -jar \"%splantuml.jar\" -h' works from the command line. Exit code: %d\n",
-        plantumlJarPath.data(),exitCode);
+    pumlCommonArgs += "-Dplantuml.include.path=\"";
+    pumlCommonArgs += QFileInfo(s).absFilePath().utf8();
+    s = pumlIncludePathList.next(); 
   }
-  else if (Config_getBool("DOT_CLEANUP"))
+  while (s)
   {
-    QFile(QCString(baseName)+".pu").remove();
+    pumlCommonArgs += portable_pathListSeparator();
+    pumlCommonArgs += QFileInfo(s).absFilePath().utf8();
+    s = pumlIncludePathList.next(); 
   }
-  portable_sysTimerStop();
-  if ( (format==PUML_EPS) && (Config_getBool("USE_PDFLATEX")) )
+  if (pumlIncludePathList.first()) pumlCommonArgs += "\" ";
+  pumlCommonArgs += "-Djava.awt.headless=true -jar \""+plantumlJarPath+"plantuml.jar\" ";
+  QCString errorMsg;
+  errorMsg.sprintf("Problems running PlantUML. Verify that the command 'java -jar \"%splantuml.jar\" -h' works from the command line.",
+                   plantumlJarPath.data());
+
+  QListIterator<Group> gli(m_groups);
+  Group *group;
+  for (;(group=gli.current());++gli)
   {
-    QCString epstopdfArgs(maxCmdLine);
-    epstopdfArgs.sprintf("\"%s.eps\" --outfile=\"%s.pdf\"",baseName,baseName);
-    portable_sysTimerStart();
-    if ((exitCode=portable_system("epstopdf",epstopdfArgs))!=0)
+    QCString pumlArgs = pumlCommonArgs;
+    QCString extension;
+    pumlArgs+="-o \"";
+    pumlArgs+=group->outDir;
+    pumlArgs+="\" ";
+    switch (group->format)
     {
-      err("Problems running epstopdf. Check your TeX installation! Exit code: %d\n",exitCode);
+      case PUML_BITMAP:
+        pumlArgs+="-tpng";
+        extension=".png";
+        break;
+      case PUML_EPS:
+        pumlArgs+="-teps";
+        extension=".eps";
+        break;
+      case PUML_SVG:
+        pumlArgs+="-tsvg";
+        extension=".svg";
+        break;
     }
-    portable_sysTimerStop();
+    pumlArgs+=" -charset UTF-8";
+    msg("Running PlantUML on %d generated files in %s\n",group->files.count(),group->outDir.data());
+    DiagramJob *job = 0;
+    QCString jobArgs;
+    const char *baseName;
+    for (baseName=group->files.first();baseName;baseName=group->files.next())
+    {
+      QCString puFile = QCString(baseName)+".pu";
+      if (job && jobArgs.length()+puFile.length()+3>=(uint)maxCmdLine)
+      {
+        // start a new run to stay below the maximum command line length
+        DiagramJobManager::instance()->addJob(job);
+        job=0;
+      }
+      if (job==0)
+      {
+        job = new DiagramJob(pumlExe,"",TRUE,errorMsg);
+        jobArgs = pumlArgs;
+      }
+      jobArgs+=" \""+puFile+"\"";
+      job->setArgs(jobArgs);
+      if (group->format==PUML_EPS) job->addEpsFile(baseName);
+      if (dotCleanUp)
+      {
+        job->addRemoveFile(puFile,group->outDir+"/"+stripPath(baseName)+extension);
+      }
+    }
+    if (job) DiagramJobManager::instance()->addJob(job);
   }
+  m_groups.clear();
 }
-
@@ -16,6 +16,8 @@
 #ifndef PLANTUML_H
 #define PLANTUML_H
 
+#include <qlist.h>
+
 class QCString;
 
 /** Plant UML output image formats */
@@ -29,12 +31,34 @@ enum PlantUMLOutputFormat { PUML_BITMAP, PUML_EPS, PUML_SVG };
  */
 QCString writePlantUMLSource(const QCString &outDir,const QCString &fileName,const QCString &content);
 
-/** Convert a PlantUML file to an image.
+/** Convert a PlantUML file to an image. The conversion is done when
+ *  PlantumlManager::run() is called, unless the file did not change
+ *  since the previous run.
  *  @param[in] baseName the name of the generated file (as returned by writePlantUMLSource())
  *  @param[in] outDir   the directory to write the resulting image into.
  *  @param[in] format   the image format to generate.
  */
 void generatePlantUMLOutput(const char *baseName,const char *outDir,PlantUMLOutputFormat format);
 
+/** Singleton that collects the PlantUML files to convert, so a single run 
+ *  of PlantUML can convert all files with the same output directory and 
+ *  format.
+ */
+class PlantumlManager
+{
+  public:
+    static PlantumlManager *instance();
+    /** Adds file \a baseName.pu to convert into \a outDir */
+    void insert(const char *baseName,const char *outDir,PlantUMLOutputFormat format);
+    /** Hands the conversions to the DiagramJobManager */
+    void run();
+
+  private:
+    PlantumlManager();
+    struct Group;
+    static PlantumlManager *m_theInstance;
+    QList<Group> m_groups;
+};
+
 #endif
 
@@ -9,6 +9,11 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <fcntl.h>
 #include <errno.h>
 extern char **environ;
 #endif
@@ -422,6 +427,49 @@ double portable_getSysElapsedTime()
   return g_sysElapsedTime;
 }
 
+/*! Returns the processor time (user and system) used by this process
+ *  so far, in seconds.
+ */
+double portable_getCpuTime()
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  FILETIME creationTime,exitTime,kernelTime,userTime;
+  if (!GetProcessTimes(GetCurrentProcess(),&creationTime,&exitTime,&kernelTime,&userTime))
+  {
+    return 0.0;
+  }
+  ULARGE_INTEGER k,u;
+  k.LowPart  = kernelTime.dwLowDateTime;
+  k.HighPart = kernelTime.dwHighDateTime;
+  u.LowPart  = userTime.dwLowDateTime;
+  u.HighPart = userTime.dwHighDateTime;
+  return (double)(k.QuadPart+u.QuadPart)/1.0e7; // in units of 100ns
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF,&usage)!=0) return 0.0;
+  return usage.ru_utime.tv_sec+usage.ru_utime.tv_usec/1.0e6+
+         usage.ru_stime.tv_sec+usage.ru_stime.tv_usec/1.0e6;
+#endif
+}
+
+/*! Returns the peak resident set size of this process in kilobytes,
+ *  or 0 if it is not known on this platform.
+ */
+long portable_getPeakMemoryUsage()
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF,&usage)!=0) return 0;
+#if defined(_OS_MAC_)
+  return usage.ru_maxrss/1024; // reported in bytes
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
 void portable_sleep(int ms)
 {
 #if defined(_WIN32) && !defined(__CYGWIN__)
@@ -431,6 +479,53 @@ void portable_sleep(int ms)
 #endif
 }
 
+const char *portable_mapFile(const char *fileName,portable_off_t &size)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  HANDLE file = CreateFile(fileName,GENERIC_READ,FILE_SHARE_READ,NULL,
+                           OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+  if (file==INVALID_HANDLE_VALUE) return 0;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file,&fileSize) || fileSize.QuadPart==0)
+  {
+    CloseHandle(file);
+    return 0;
+  }
+  HANDLE mapping = CreateFileMapping(file,NULL,PAGE_READONLY,0,0,NULL);
+  CloseHandle(file);
+  if (mapping==NULL) return 0;
+  void *data = MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+  CloseHandle(mapping); // the view keeps the mapping alive
+  if (data==NULL) return 0;
+  size = fileSize.QuadPart;
+  return (const char *)data;
+#else
+  int fd = open(fileName,O_RDONLY);
+  if (fd==-1) return 0;
+  struct stat st;
+  if (fstat(fd,&st)==-1 || st.st_size==0)
+  {
+    close(fd);
+    return 0;
+  }
+  void *data = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd); // the mapping stays valid
+  if (data==MAP_FAILED) return 0;
+  size = st.st_size;
+  return (const char *)data;
+#endif
+}
+
+void portable_unmapFile(const char *data,portable_off_t size)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  (void)size;
+  UnmapViewOfFile(data);
+#else
+  munmap((void *)data,size);
+#endif
+}
+
 bool portable_isAbsolutePath(const char *fileName)
 {
 # ifdef _WIN32
@@ -33,8 +33,12 @@ int            portable_pclose(FILE *stream);
 void           portable_sysTimerStart();
 void           portable_sysTimerStop();
 double         portable_getSysElapsedTime();
+double         portable_getCpuTime();
+long           portable_getPeakMemoryUsage();
 void           portable_sleep(int ms);
 bool           portable_isAbsolutePath(const char *fileName);
+const char *   portable_mapFile(const char *fileName,portable_off_t &size);
+void           portable_unmapFile(const char *data,portable_off_t size);
 
 extern "C" {
   void *         portable_iconv_open(const char* tocode, const char* fromcode);
@@ -19,6 +19,7 @@
 #include <assert.h>
 
 #include <qfile.h>
+#include <qdir.h>
 #include <qregexp.h>
 
 #include "searchindex.h"
@@ -37,53 +38,132 @@
 #include "filename.h"
 #include "membername.h"
 #include "resourcemgr.h"
-
-// file format: (all multi-byte values are stored in big endian format)
-//   4 byte header
-//   256*256*4 byte index (4 bytes)
-//   for each index entry: a zero terminated list of words 
-//   for each word: a \0 terminated string + 4 byte offset to the stats info
-//   padding bytes to align at 4 byte boundary
-//   for each word: the number of urls (4 bytes) 
-//               + for each url containing the word 8 bytes statistics
-//                 (4 bytes index to url string + 4 bytes frequency counter)
-//   for each url: a \0 terminated string
+#include "portable.h"
+
+// file format: (all fixed size multi-byte values are stored in big endian format)
+//   4 byte header "DOX2"
+//   4 byte offset of the postings
+//   4 byte offset of the url table
+//   4 byte number of urls
+//   256*256*4 byte index with the offset of the word list for each pair
+//     of starting characters (0 if there are no words)
+//   for each word (grouped per index entry in sorted order):
+//     the number of urls (varint) 
+//     + for each url containing the word, ordered by url index:
+//       the difference with the previous url index (varint) and
+//       the frequency counter (varint)
+//   for each index entry with words: the number of words (varint)
+//     + for each word in sorted order: the length of the prefix shared with
+//       the previous word (1 byte), the rest of the word as a \0 terminated 
+//       string, and the offset of the word's postings relative to the start
+//       of the postings (varint)
+//   the url table: for each url the offset of its strings relative to the
+//     end of the table (4 bytes)
+//   for each url: a \0 terminated name + a \0 terminated url string
+//
+// a varint stores 7 bits per byte, least significant group first, with the
+// highest bit set on all bytes except the last.
 
 const int numIndexEntries = 256*256;
 
+// number of postings that are kept in memory before they are written to
+// a temporary file
+#define POSTING_BUFFER_SIZE (1024*1024)
+
+// number of postings read at once when merging the temporary files
+#define POSTING_READ_SIZE   4096
+
 //--------------------------------------------------------------------
 
-IndexWord::IndexWord(const char *word) : m_word(word), m_urls(17)
+/** A sorted sequence of postings, either in memory or in the temporary
+ *  file of the search index. 
+ */
+struct SearchPostingRun
 {
-  m_urls.setAutoDelete(TRUE);
-  //printf("IndexWord::IndexWord(%s)\n",word);
+  SearchPostingRun(QFile *f,int offset,uint count) 
+    : file(f), offset(offset), count(count), 
+      buffer(new SearchPosting[QMIN(count,POSTING_READ_SIZE)]), 
+      data(buffer), pos(0), len(0)
+  {
+    fill();
+  }
+  SearchPostingRun(const SearchPosting *d,uint count)
+    : file(0), offset(0), count(0), buffer(0), data(d), pos(0), len(count)
+  {
+  }
+ ~SearchPostingRun()
+  {
+    delete[] buffer;
+  }
+  const SearchPosting *current() const 
+  { 
+    return pos<len ? &data[pos] : 0; 
+  }
+  void next()
+  {
+    pos++;
+    if (pos==len && file) fill();
+  }
+  void fill()
+  {
+    uint n = QMIN(count,POSTING_READ_SIZE);
+    if (n>0)
+    {
+      file->at(offset);
+      file->readBlock((char *)buffer,n*sizeof(SearchPosting));
+      offset+=n*sizeof(SearchPosting);
+      count-=n;
+    }
+    pos=0;
+    len=n;
+  }
+
+  QFile *file;
+  int    offset;
+  uint   count;
+  SearchPosting *buffer;
+  const SearchPosting *data;
+  uint   pos;
+  uint   len;
+};
+
+static int comparePostings(const SearchPosting *p1,const SearchPosting *p2)
+{
+  if (p1->wordId!=p2->wordId) return p1->wordId<p2->wordId ? -1 : 1;
+  return p1->urlIdx-p2->urlIdx;
 }
 
-void IndexWord::addUrlIndex(int idx,bool hiPriority)
+static int comparePostingsQSort(const void *p1,const void *p2)
 {
-  //printf("IndexWord::addUrlIndex(%d,%d)\n",idx,hiPriority);
-  URLInfo *ui = m_urls.find(idx);
-  if (ui==0)
-  {
-    //printf("URLInfo::URLInfo(%d)\n",idx);
-    ui=new URLInfo(idx,0);
-    m_urls.insert(idx,ui);
-  }
-  ui->freq+=2;
-  if (hiPriority) ui->freq|=1; // mark as high priority document
+  return comparePostings((const SearchPosting *)p1,(const SearchPosting *)p2);
+}
+
+static int combineFreq(int freq1,int freq2)
+{
+  return ((freq1&~1)+(freq2&~1)) | ((freq1|freq2)&1);
 }
 
 //--------------------------------------------------------------------
 
 SearchIndex::SearchIndex() : SearchIndexIntf(Internal), 
-      m_words(328829), m_index(numIndexEntries), m_url2IdMap(10007), m_urls(10007), m_urlIndex(-1)
+      m_words(328829), m_url2IdMap(10007), m_urls(10007), m_urlIndex(-1),
+      m_postings(new SearchPosting[POSTING_BUFFER_SIZE]), m_numPostings(0),
+      m_runFile(0)
 {
-  int i;
   m_words.setAutoDelete(TRUE);
   m_url2IdMap.setAutoDelete(TRUE);
   m_urls.setAutoDelete(TRUE);
-  m_index.setAutoDelete(TRUE);
-  for (i=0;i<numIndexEntries;i++) m_index.insert(i,new QList<IndexWord>);
+  m_runs.setAutoDelete(TRUE);
+}
+
+SearchIndex::~SearchIndex()
+{
+  delete[] m_postings;
+  if (m_runFile)
+  {
+    delete m_runFile;
+    QDir::current().remove(m_runFileName);
+  }
 }
 
 void SearchIndex::setCurrentDoc(Definition *ctx,const char *anchor,bool isSourceFile)
@@ -214,11 +294,28 @@ void SearchIndex::addWord(const char *word,bool hiPriority,bool recurse)
     int idx=charsToIndex(wStr);
     //fprintf(stderr,"addWord(%s) at index %d\n",word,idx);
     if (idx<0) return;
-    w = new IndexWord(wStr);
-    m_index[idx]->append(w);
+    w = new IndexWord(wStr,m_words.count());
     m_words.insert(wStr,w);
   }
-  w->addUrlIndex(m_urlIndex,hiPriority);
+  if (m_urlIndex>=0)
+  {
+    SearchPosting *p = &m_postings[w->m_lastPos];
+    if (w->m_lastPos<m_numPostings && p->wordId==w->id() && p->urlIdx==m_urlIndex)
+    {
+      // word was found before in the same document
+      p->freq+=2;
+    }
+    else
+    {
+      if (m_numPostings==POSTING_BUFFER_SIZE) spillPostings();
+      w->m_lastPos = m_numPostings++;
+      p = &m_postings[w->m_lastPos];
+      p->wordId = w->id();
+      p->urlIdx = m_urlIndex;
+      p->freq   = 2;
+    }
+    if (hiPriority) p->freq|=1; // mark as high priority document
+  }
   int i;
   bool found=FALSE;
   if (!recurse) // the first time we check if we can strip the prefix
@@ -259,152 +356,239 @@ static void writeString(QFile &f,const char *s)
   f.putch(0);
 }
 
-void SearchIndex::write(const char *fileName)
+static void addVarint(GrowBuf &buf,uint v)
 {
-  int i;
-  int size=4; // for the header
-  size+=4*numIndexEntries; // for the index
-  int wordsOffset = size;
-  // first pass: compute the size of the wordlist
-  for (i=0;i<numIndexEntries;i++)
+  while (v>=0x80)
   {
-    QList<IndexWord> *wlist = m_index[i];
-    if (!wlist->isEmpty())
-    {
-      QListIterator<IndexWord> iwi(*wlist);
-      IndexWord *iw;
-      for (iwi.toFirst();(iw=iwi.current());++iwi)
-      {
-        int ws = iw->word().length()+1; 
-        size+=ws+4; // word + url info list offset
-      }
-      size+=1; // zero list terminator
-    }
+    buf.addChar((char)((v&0x7f)|0x80));
+    v>>=7;
   }
+  buf.addChar((char)v);
+}
 
-  // second pass: compute the offsets in the index
-  int indexOffsets[numIndexEntries];
-  int offset=wordsOffset;
-  for (i=0;i<numIndexEntries;i++)
+static void writeVarint(QFile &f,uint v)
+{
+  while (v>=0x80)
+  {
+    f.putch((v&0x7f)|0x80);
+    v>>=7;
+  }
+  f.putch(v);
+}
+
+/*! Sorts the postings in memory and combines the ones for the same word 
+ *  and document.
+ */
+void SearchIndex::sortPostings()
+{
+  if (m_numPostings==0) return;
+  qsort(m_postings,m_numPostings,sizeof(SearchPosting),comparePostingsQSort);
+  uint i,j=0;
+  for (i=1;i<m_numPostings;i++)
   {
-    QList<IndexWord> *wlist = m_index[i];
-    if (!wlist->isEmpty())
+    if (comparePostings(&m_postings[i],&m_postings[j])==0)
     {
-      indexOffsets[i]=offset;
-      QListIterator<IndexWord> iwi(*wlist);
-      IndexWord *iw;
-      for (iwi.toFirst();(iw=iwi.current());++iwi)
-      {
-        offset+= iw->word().length()+1; 
-        offset+=4; // word + offset to url info array 
-      }
-      offset+=1; // zero list terminator
+      m_postings[j].freq = combineFreq(m_postings[j].freq,m_postings[i].freq);
     }
     else
     {
-      indexOffsets[i]=0;
+      m_postings[++j] = m_postings[i];
     }
   }
-  int padding = size;
-  size = (size+3)&~3; // round up to 4 byte boundary
-  padding = size - padding;
-
-  //int statsOffset = size;
-  //IndexWord *iw;
-  int *wordStatOffsets = new int[m_words.count()];
-  
-  int count=0;
+  m_numPostings=j+1;
+}
 
-  // third pass: compute offset to stats info for each word
-  for (i=0;i<numIndexEntries;i++)
+/*! Writes the postings in memory as a sorted run to a temporary file, 
+ *  so the memory needed does not grow with the size of the index.
+ */
+void SearchIndex::spillPostings()
+{
+  sortPostings();
+  if (m_runFile==0)
   {
-    QList<IndexWord> *wlist = m_index[i];
-    if (!wlist->isEmpty())
+    m_runFileName.sprintf("doxygen_search_%d.tmp",portable_pid());
+    m_runFileName.prepend(Config_getString("OUTPUT_DIRECTORY")+"/");
+    m_runFile = new QFile(m_runFileName);
+    if (!m_runFile->open(IO_ReadWrite|IO_Truncate))
     {
-      QListIterator<IndexWord> iwi(*wlist);
-      IndexWord *iw;
-      for (iwi.toFirst();(iw=iwi.current());++iwi)
-      {
-        //printf("wordStatOffsets[%d]=%d\n",count,size);
-        wordStatOffsets[count++] = size;
-        size+=4+iw->urls().count()*8; // count + (url_index,freq) per url
-      }
+      err("Failed to open temporary file %s for the search index\n",m_runFileName.data());
+      exit(1);
     }
   }
-  int *urlOffsets = new int[m_urls.count()];
-  //int urlsOffset = size;
-  QIntDictIterator<URL> udi(m_urls);
-  URL *url;
-  for (udi.toFirst();(url=udi.current());++udi)
+  int offset = m_runFile->at();
+  m_runFile->writeBlock((const char *)m_postings,m_numPostings*sizeof(SearchPosting));
+  m_runs.append(new SearchPostingRun(m_runFile,offset,m_numPostings));
+  m_numPostings=0;
+}
+
+static bool runLessThan(SearchPostingRun *r1,SearchPostingRun *r2)
+{
+  return comparePostings(r1->current(),r2->current())<0;
+}
+
+static void siftDown(SearchPostingRun **heap,int size,int i)
+{
+  for (;;)
   {
-    urlOffsets[udi.currentKey()]=size;
-    size+=url->name.length()+1+
-          url->url.length()+1;
+    int smallest=i;
+    int l=2*i+1, r=2*i+2;
+    if (l<size && runLessThan(heap[l],heap[smallest])) smallest=l;
+    if (r<size && runLessThan(heap[r],heap[smallest])) smallest=r;
+    if (smallest==i) return;
+    SearchPostingRun *tmp=heap[i]; heap[i]=heap[smallest]; heap[smallest]=tmp;
+    i=smallest;
   }
-  //printf("Total size %x bytes (word=%x stats=%x urls=%x)\n",size,wordsOffset,statsOffset,urlsOffset);
+}
+
+static int compareIndexWords(const void *p1,const void *p2)
+{
+  return qstrcmp((*(IndexWord **)p1)->word(),(*(IndexWord **)p2)->word());
+}
+
+void SearchIndex::write(const char *fileName)
+{
   QFile f(fileName);
-  if (f.open(IO_WriteOnly))
+  if (!f.open(IO_WriteOnly))
   {
-    // write header
-    f.putch('D'); f.putch('O'); f.putch('X'); f.putch('S');
-    // write index
-    for (i=0;i<numIndexEntries;i++)
-    {
-      writeInt(f,indexOffsets[i]);
-    }
-    // write word lists
-    count=0;
-    for (i=0;i<numIndexEntries;i++)
+    err("Failed to open %s for writing\n",fileName);
+    return;
+  }
+  int i;
+  // the header and index are written at the end, when all offsets are known
+  const int postingsOffset = 16+4*numIndexEntries;
+  f.at(postingsOffset);
+
+  // merge the postings of the temporary runs and the ones still in memory
+  sortPostings();
+  SearchPostingRun memRun(m_postings,m_numPostings);
+  int numRuns = m_runs.count()+1;
+  SearchPostingRun **heap = new SearchPostingRun*[numRuns];
+  int heapSize=0;
+  QListIterator<SearchPostingRun> rli(m_runs);
+  SearchPostingRun *run;
+  for (;(run=rli.current());++rli)
+  {
+    if (run->current()) heap[heapSize++]=run;
+  }
+  if (memRun.current()) heap[heapSize++]=&memRun;
+  for (i=heapSize/2-1;i>=0;i--) siftDown(heap,heapSize,i);
+
+  // write the postings word by word; the postings of a word are collected
+  // first since the number of urls is written in front of them
+  uint numWords = m_words.count();
+  uint *wordOffsets = new uint[numWords];
+  for (i=0;i<(int)numWords;i++) wordOffsets[i]=(uint)-1;
+  GrowBuf buf;
+  uint curWord=0, numUrls=0;
+  int prevUrl=0;
+  SearchPosting pending;
+  bool hasPending=FALSE;
+  for (;;)
+  {
+    SearchPosting p;
+    bool done = heapSize==0;
+    if (!done)
     {
-      QList<IndexWord> *wlist = m_index[i];
-      if (!wlist->isEmpty())
+      p = *heap[0]->current();
+      heap[0]->next();
+      if (heap[0]->current()==0) heap[0]=heap[--heapSize];
+      siftDown(heap,heapSize,0);
+      if (hasPending && p.wordId==pending.wordId && p.urlIdx==pending.urlIdx)
       {
-        QListIterator<IndexWord> iwi(*wlist);
-        IndexWord *iw;
-        for (iwi.toFirst();(iw=iwi.current());++iwi)
-        {
-          writeString(f,iw->word());
-          writeInt(f,wordStatOffsets[count++]);
-        }
-        f.putch(0);
+        // same word and document in different runs
+        pending.freq = combineFreq(pending.freq,p.freq);
+        continue;
       }
     }
-    // write extra padding bytes
-    for (i=0;i<padding;i++) f.putch(0);
-    // write word statistics
-    for (i=0;i<numIndexEntries;i++)
+    if (hasPending)
     {
-      QList<IndexWord> *wlist = m_index[i];
-      if (!wlist->isEmpty())
-      {
-        QListIterator<IndexWord> iwi(*wlist);
-        IndexWord *iw;
-        for (iwi.toFirst();(iw=iwi.current());++iwi)
-        {
-          int numUrls = iw->urls().count();
-          writeInt(f,numUrls);
-          QIntDictIterator<URLInfo> uli(iw->urls());
-          URLInfo *ui;
-          for (uli.toFirst();(ui=uli.current());++uli)
-          {
-            writeInt(f,urlOffsets[ui->urlIdx]);
-            writeInt(f,ui->freq);
-          }
-        }
-      }
+      addVarint(buf,pending.urlIdx-prevUrl);
+      addVarint(buf,pending.freq);
+      prevUrl=pending.urlIdx;
+      numUrls++;
     }
-    // write urls
-    QIntDictIterator<URL> udi(m_urls);
-    URL *url;
-    for (udi.toFirst();(url=udi.current());++udi)
+    if (numUrls>0 && (done || p.wordId!=curWord))
     {
-      writeString(f,url->name);
-      writeString(f,url->url);
+      wordOffsets[curWord] = f.at()-postingsOffset;
+      writeVarint(f,numUrls);
+      f.writeBlock(buf.get(),buf.getPos());
+      buf.clear();
+      numUrls=0;
+      prevUrl=0;
     }
+    if (done) break;
+    curWord=p.wordId;
+    pending=p;
+    hasPending=TRUE;
+  }
+  delete[] heap;
+  delete m_runFile;
+  m_runFile=0;
+  m_runs.clear();
+  QDir::current().remove(m_runFileName);
+
+  // write the sorted word lists
+  IndexWord **words = new IndexWord*[numWords];
+  QDictIterator<IndexWord> wdi(m_words);
+  IndexWord *iw;
+  uint count=0;
+  for (;(iw=wdi.current());++wdi)
+  {
+    if (wordOffsets[iw->id()]!=(uint)-1) words[count++]=iw;
+  }
+  qsort(words,count,sizeof(IndexWord*),compareIndexWords);
+  int *indexOffsets = new int[numIndexEntries];
+  memset(indexOffsets,0,numIndexEntries*sizeof(int));
+  uint w=0;
+  while (w<count)
+  {
+    int idx = charsToIndex(words[w]->word());
+    uint last=w;
+    while (last<count && charsToIndex(words[last]->word())==idx) last++;
+    indexOffsets[idx]=f.at();
+    writeVarint(f,last-w);
+    QCString prev;
+    for (;w<last;w++)
+    {
+      QCString word = words[w]->word();
+      uint shared=0;
+      while (shared<254 && shared<prev.length() && prev.at(shared)==word.at(shared)) shared++;
+      f.putch(shared);
+      writeString(f,word.data()+shared);
+      writeVarint(f,wordOffsets[words[w]->id()]);
+      prev=word;
+    }
+  }
+  delete[] words;
+  delete[] wordOffsets;
+
+  // write the url table and the urls
+  int urlTableOffset = f.at();
+  int urlOffset=0;
+  for (i=0;i<=m_urlIndex;i++)
+  {
+    writeInt(f,urlOffset);
+    URL *url = m_urls.find(i);
+    urlOffset+=url->name.length()+1+url->url.length()+1;
+  }
+  for (i=0;i<=m_urlIndex;i++)
+  {
+    URL *url = m_urls.find(i);
+    writeString(f,url->name);
+    writeString(f,url->url);
   }
 
-  delete[] urlOffsets;
-  delete[] wordStatOffsets;
+  // write the header and index
+  f.at(0);
+  f.putch('D'); f.putch('O'); f.putch('X'); f.putch('2');
+  writeInt(f,postingsOffset);
+  writeInt(f,urlTableOffset);
+  writeInt(f,m_urlIndex+1);
+  for (i=0;i<numIndexEntries;i++)
+  {
+    writeInt(f,indexOffsets[i]);
+  }
+  delete[] indexOffsets;
 }
 
 
@@ -900,254 +1084,397 @@ void createJavascriptSearchIndex()
   }
 }
 
-void writeJavascriptSearchIndex()
+// maximum number of entries in one file of the javascript search index,
+// letters with more entries are split on longer prefixes of the search id
+#define SEARCH_SHARD_SIZE 1000
+
+// maximum length of the prefixes used to split the javascript search index
+#define MAX_SEARCH_SHARD_PREFIX 8
+
+/** The entries of the javascript search index starting with a prefix */
+struct SearchShard
 {
-  int i;
-  // write index files
-  QCString searchDirName = Config_getString("HTML_OUTPUT")+"/search";
+  SearchShard(const QCString &p) : prefix(p) {}
+  QCString prefix;
+  QList<SearchDefinitionList> items;
+};
 
-  for (i=0;i<NUM_SEARCH_INDICES;i++) // for each index
+/** Returns the first \a len characters of search id \a id, 
+ *  without splitting a multibyte UTF-8 character.
+ */
+static QCString searchIdPrefix(const QCString &id,uint len)
+{
+  while (len<id.length() && (((uchar)id.at(len))&0xC0)==0x80) len++;
+  return id.left(len);
+}
+
+static void splitSearchShards(const QCString &prefix,
+                              const QList<SearchDefinitionList> &items,
+                              QList<SearchShard> &shards)
+{
+  if (items.count()<=SEARCH_SHARD_SIZE || prefix.length()>=MAX_SEARCH_SHARD_PREFIX)
   {
-    SIntDict<SearchIndexList>::Iterator it(g_searchIndexInfo[i].symbolList);
-    SearchIndexList *sl;
-    int p=0;
-    for (it.toFirst();(sl=it.current());++it,++p) // for each letter
+    SearchShard *shard = new SearchShard(prefix);
+    shard->items = items;
+    shards.append(shard);
+    return;
+  }
+  // group the items on the next character of their id
+  QDict<SearchShard> groups(257);
+  groups.setAutoDelete(TRUE);
+  QStrList keys;
+  QListIterator<SearchDefinitionList> li(items);
+  SearchDefinitionList *dl;
+  for (li.toFirst();(dl=li.current());++li)
+  {
+    QCString key = searchIdPrefix(dl->id(),prefix.length()+1);
+    SearchShard *group = groups.find(key);
+    if (group==0)
     {
-      QCString baseName;
-      baseName.sprintf("%s_%x",g_searchIndexInfo[i].name.data(),p);
+      group = new SearchShard(key);
+      groups.insert(key,group);
+      keys.append(key);
+    }
+    group->items.append(dl);
+  }
+  keys.sort();
+  QStrListIterator ki(keys);
+  const char *key;
+  for (ki.toFirst();(key=ki.current());++ki)
+  {
+    SearchShard *group = groups.find(key);
+    if (group->prefix==prefix) // ids equal to the prefix, cannot be split further
+    {
+      shards.append(new SearchShard(prefix));
+      shards.getLast()->items = group->items;
+    }
+    else
+    {
+      splitSearchShards(group->prefix,group->items,shards);
+    }
+  }
+}
 
-      QCString fileName = searchDirName + "/"+baseName+".html";
-      QCString dataFileName = searchDirName + "/"+baseName+".js";
+/** Strings shared by the entries of a javascript search index file,
+ *  such as the names of the output files and scopes.
+ */
+class SearchStringTable
+{
+  public:
+    SearchStringTable() : m_dict(1009) 
+    { 
+      m_dict.setAutoDelete(TRUE); 
+      m_strings.append(""); // index 0 is the empty string
+    }
+    int index(const QCString &s)
+    {
+      if (s.isEmpty()) return 0;
+      int *pIdx = m_dict.find(s);
+      if (pIdx) return *pIdx;
+      int idx = m_strings.count();
+      m_dict.insert(s,new int(idx));
+      m_strings.append(s);
+      return idx;
+    }
+    void write(FTextStream &t) const
+    {
+      t << "[";
+      QStrListIterator li(m_strings);
+      const char *s;
+      bool first=TRUE;
+      for (li.toFirst();(s=li.current());++li)
+      {
+        if (!first) t << ",";
+        t << "'" << s << "'";
+        first=FALSE;
+      }
+      t << "]";
+    }
+  private:
+    QDict<int> m_dict;
+    QStrList   m_strings;
+};
 
-      QFile outFile(fileName);
-      QFile dataOutFile(dataFileName);
-      if (outFile.open(IO_WriteOnly) && dataOutFile.open(IO_WriteOnly))
+static void writeSearchShard(const QCString &fileName,const SearchShard *shard)
+{
+  QFile dataOutFile(fileName);
+  if (!dataOutFile.open(IO_WriteOnly))
+  {
+    err("Failed to open file '%s' for writing...\n",fileName.data());
+    return;
+  }
+  // format
+  // addSearchData(strings,items)
+  // strings[] = array of strings shared by the items
+  // items[] = array of items
+  // items[x][0] = id
+  // items[x][1] = [ name + child1 + child2 + .. ]
+  // items[x][1][0] = name as shown
+  // items[x][1][y+1] = info for child y
+  // items[x][1][y+1][0] = index of the url of the page in strings
+  // items[x][1][y+1][1] = anchor within the page
+  // items[x][1][y+1][2] = 1 => target="_parent"
+  // items[x][1][y+1][3] = index of the scope in strings
+  SearchStringTable strings;
+  QGString data;
+  {
+    FTextStream ti(&data);
+    ti << "[" << endl;
+    bool firstEntry=TRUE;
+
+    QListIterator<SearchDefinitionList> li(shard->items);
+    SearchDefinitionList *dl;
+    for (li.toFirst();(dl=li.current());++li)
+    {
+      Definition *d = dl->getFirst();
+
+      if (!firstEntry)
       {
+        ti << "," << endl;
+      }
+      firstEntry=FALSE;
+
+      ti << "  ['" << dl->id() << "',['" << convertToXML(dl->name()) << "',[";
+
+      if (dl->count()==1) // item with a unique name
+      {
+        MemberDef  *md   = 0;
+        bool isMemberDef = d->definitionType()==Definition::TypeMember;
+        if (isMemberDef) md = (MemberDef*)d;
+
+        ti << strings.index(externalRef("../",d->getReference(),TRUE)+
+                            d->getOutputFileBase()+Doxygen::htmlFileExtension);
+        ti << ",'" << d->anchor() << "',";
+
+        static bool extLinksInWindow = Config_getBool("EXT_LINKS_IN_WINDOW");
+        if (!extLinksInWindow || d->getReference().isEmpty())
         {
-          FTextStream t(&outFile);
-
-          t << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\""
-            " \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">" << endl;
-          t << "<html><head><title></title>" << endl;
-          t << "<meta http-equiv=\"Content-Type\" content=\"text/xhtml;charset=UTF-8\"/>" << endl;
-          t << "<meta name=\"generator\" content=\"Doxygen " << versionString << "\"/>" << endl;
-          t << "<link rel=\"stylesheet\" type=\"text/css\" href=\"search.css\"/>" << endl;
-          t << "<script type=\"text/javascript\" src=\"" << baseName << ".js\"></script>" << endl;
-          t << "<script type=\"text/javascript\" src=\"search.js\"></script>" << endl;
-          t << "</head>" << endl;
-          t << "<body class=\"SRPage\">" << endl;
-          t << "<div id=\"SRIndex\">" << endl;
-          t << "<div class=\"SRStatus\" id=\"Loading\">" << theTranslator->trLoading() << "</div>" << endl;
-          t << "<div id=\"SRResults\"></div>" << endl; // here the results will be inserted
-          t << "<script type=\"text/javascript\"><!--" << endl;
-          t << "createResults();" << endl; // this function will insert the results
-          t << "--></script>" << endl;
-          t << "<div class=\"SRStatus\" id=\"Searching\">" 
-            << theTranslator->trSearching() << "</div>" << endl;
-          t << "<div class=\"SRStatus\" id=\"NoMatches\">"
-            << theTranslator->trNoMatches() << "</div>" << endl;
-
-          t << "<script type=\"text/javascript\"><!--" << endl;
-          t << "document.getElementById(\"Loading\").style.display=\"none\";" << endl;
-          t << "document.getElementById(\"NoMatches\").style.display=\"none\";" << endl;
-          t << "var searchResults = new SearchResults(\"searchResults\");" << endl;
-          t << "searchResults.Search();" << endl;
-          t << "--></script>" << endl;
-          t << "</div>" << endl; // SRIndex
-          t << "</body>" << endl;
-          t << "</html>" << endl;
+          ti << "1,";
         }
-        FTextStream ti(&dataOutFile);
-
-        ti << "var searchData=" << endl;
-        // format
-        // searchData[] = array of items
-        // searchData[x][0] = id
-        // searchData[x][1] = [ name + child1 + child2 + .. ]
-        // searchData[x][1][0] = name as shown
-        // searchData[x][1][y+1] = info for child y
-        // searchData[x][1][y+1][0] = url
-        // searchData[x][1][y+1][1] = 1 => target="_parent"
-        // searchData[x][1][y+1][2] = scope
-
-        ti << "[" << endl;
-        bool firstEntry=TRUE;
-
-        SDict<SearchDefinitionList>::Iterator li(*sl);
-        SearchDefinitionList *dl;
-        int itemCount=0;
-        for (li.toFirst();(dl=li.current());++li)
+        else
         {
-          Definition *d = dl->getFirst();
+          ti << "0,";
+        }
 
-          if (!firstEntry)
+        QCString scope;
+        if (d->getOuterScope()!=Doxygen::globalScope)
+        {
+          scope = convertToXML(d->getOuterScope()->name());
+        }
+        else if (md)
+        {
+          FileDef *fd = md->getBodyDef();
+          if (fd==0) fd = md->getFileDef();
+          if (fd)
           {
-            ti << "," << endl;
+            scope = convertToXML(fd->localName());
           }
-          firstEntry=FALSE;
-
-          ti << "  ['" << dl->id() << "',['" << convertToXML(dl->name()) << "',[";
-
-          if (dl->count()==1) // item with a unique name
+        }
+        ti << strings.index(scope);
+        ti << "]]";
+      }
+      else // multiple items with the same name
+      {
+        QListIterator<Definition> di(*dl);
+        bool overloadedFunction = FALSE;
+        Definition *prevScope = 0;
+        int childCount=0;
+        for (di.toFirst();(d=di.current());)
+        {
+          ++di;
+          Definition *scope     = d->getOuterScope();
+          Definition *next      = di.current();
+          Definition *nextScope = 0;
+          MemberDef  *md        = 0;
+          bool isMemberDef = d->definitionType()==Definition::TypeMember;
+          if (isMemberDef) md = (MemberDef*)d;
+          if (next) nextScope = next->getOuterScope();
+
+          if (childCount>0)
           {
-            MemberDef  *md   = 0;
-            bool isMemberDef = d->definitionType()==Definition::TypeMember;
-            if (isMemberDef) md = (MemberDef*)d;
-            QCString anchor = d->anchor();
-
-            ti << "'" << externalRef("../",d->getReference(),TRUE)
-              << d->getOutputFileBase() << Doxygen::htmlFileExtension;
-            if (!anchor.isEmpty())
-            {
-              ti << "#" << anchor;
-            }
-            ti << "',";
-
-            static bool extLinksInWindow = Config_getBool("EXT_LINKS_IN_WINDOW");
-            if (!extLinksInWindow || d->getReference().isEmpty())
-            {
-              ti << "1,";
-            }
-            else
-            {
-              ti << "0,";
-            }
+            ti << "],[";
+          }
+          ti << strings.index(externalRef("../",d->getReference(),TRUE)+
+                              d->getOutputFileBase()+Doxygen::htmlFileExtension);
+          ti << ",'" << d->anchor() << "',";
 
-            if (d->getOuterScope()!=Doxygen::globalScope)
-            {
-              ti << "'" << convertToXML(d->getOuterScope()->name()) << "'";
-            }
-            else if (md)
+          static bool extLinksInWindow = Config_getBool("EXT_LINKS_IN_WINDOW");
+          if (!extLinksInWindow || d->getReference().isEmpty())
+          {
+            ti << "1,";
+          }
+          else
+          {
+            ti << "0,";
+          }
+          bool found=FALSE;
+          overloadedFunction = ((prevScope!=0 && scope==prevScope) ||
+              (scope && scope==nextScope)
+              ) && md && 
+            (md->isFunction() || md->isSlot());
+          QCString prefix;
+          if (md) prefix=convertToXML(md->localName());
+          if (overloadedFunction) // overloaded member function
+          {
+            prefix+=convertToXML(md->argsString()); 
+            // show argument list to disambiguate overloaded functions
+          }
+          else if (md) // unique member function
+          {
+            prefix+="()"; // only to show it is a function
+          }
+          QCString name;
+          if (d->definitionType()==Definition::TypeClass)
+          {
+            name = convertToXML(((ClassDef*)d)->displayName());
+            found = TRUE;
+          }
+          else if (d->definitionType()==Definition::TypeNamespace)
+          {
+            name = convertToXML(((NamespaceDef*)d)->displayName());
+            found = TRUE;
+          }
+          else if (scope==0 || scope==Doxygen::globalScope) // in global scope
+          {
+            if (md)
             {
               FileDef *fd = md->getBodyDef();
               if (fd==0) fd = md->getFileDef();
               if (fd)
               {
-                ti << "'" << convertToXML(fd->localName()) << "'";
+                if (!prefix.isEmpty()) prefix+=":&#160;";
+                name = prefix + convertToXML(fd->localName());
+                found = TRUE;
               }
             }
-            else
-            {
-              ti << "''";
-            }
-            ti << "]]";
           }
-          else // multiple items with the same name
+          else if (md && (md->getClassDef() || md->getNamespaceDef())) 
+            // member in class or namespace scope
           {
-            QListIterator<Definition> di(*dl);
-            bool overloadedFunction = FALSE;
-            Definition *prevScope = 0;
-            int childCount=0;
-            for (di.toFirst();(d=di.current());)
-            {
-              ++di;
-              Definition *scope     = d->getOuterScope();
-              Definition *next      = di.current();
-              Definition *nextScope = 0;
-              MemberDef  *md        = 0;
-              bool isMemberDef = d->definitionType()==Definition::TypeMember;
-              if (isMemberDef) md = (MemberDef*)d;
-              if (next) nextScope = next->getOuterScope();
-              QCString anchor = d->anchor();
-
-              if (childCount>0)
-              {
-                ti << "],[";
-              }
-              ti << "'" << externalRef("../",d->getReference(),TRUE)
-                << d->getOutputFileBase() << Doxygen::htmlFileExtension;
-              if (!anchor.isEmpty())
-              {
-                ti << "#" << anchor;
-              }
-              ti << "',";
+            SrcLangExt lang = md->getLanguage();
+            name = convertToXML(d->getOuterScope()->qualifiedName()) 
+              + getLanguageSpecificSeparator(lang) + prefix;
+            found = TRUE;
+          }
+          else if (scope) // some thing else? -> show scope
+          {
+            name = prefix + convertToXML(scope->name());
+            found = TRUE;
+          }
+          if (!found) // fallback
+          {
+            name = prefix + "("+theTranslator->trGlobalNamespace()+")";
+          }
 
-              static bool extLinksInWindow = Config_getBool("EXT_LINKS_IN_WINDOW");
-              if (!extLinksInWindow || d->getReference().isEmpty())
-              {
-                ti << "1,";
-              }
-              else
-              {
-                ti << "0,";
-              }
-              bool found=FALSE;
-              overloadedFunction = ((prevScope!=0 && scope==prevScope) ||
-                  (scope && scope==nextScope)
-                  ) && md && 
-                (md->isFunction() || md->isSlot());
-              QCString prefix;
-              if (md) prefix=convertToXML(md->localName());
-              if (overloadedFunction) // overloaded member function
-              {
-                prefix+=convertToXML(md->argsString()); 
-                // show argument list to disambiguate overloaded functions
-              }
-              else if (md) // unique member function
-              {
-                prefix+="()"; // only to show it is a function
-              }
-              QCString name;
-              if (d->definitionType()==Definition::TypeClass)
-              {
-                name = convertToXML(((ClassDef*)d)->displayName());
-                found = TRUE;
-              }
-              else if (d->definitionType()==Definition::TypeNamespace)
-              {
-                name = convertToXML(((NamespaceDef*)d)->displayName());
-                found = TRUE;
-              }
-              else if (scope==0 || scope==Doxygen::globalScope) // in global scope
-              {
-                if (md)
-                {
-                  FileDef *fd = md->getBodyDef();
-                  if (fd==0) fd = md->getFileDef();
-                  if (fd)
-                  {
-                    if (!prefix.isEmpty()) prefix+=":&#160;";
-                    name = prefix + convertToXML(fd->localName());
-                    found = TRUE;
-                  }
-                }
-              }
-              else if (md && (md->getClassDef() || md->getNamespaceDef())) 
-                // member in class or namespace scope
-              {
-                SrcLangExt lang = md->getLanguage();
-                name = convertToXML(d->getOuterScope()->qualifiedName()) 
-                  + getLanguageSpecificSeparator(lang) + prefix;
-                found = TRUE;
-              }
-              else if (scope) // some thing else? -> show scope
-              {
-                name = prefix + convertToXML(scope->name());
-                found = TRUE;
-              }
-              if (!found) // fallback
-              {
-                name = prefix + "("+theTranslator->trGlobalNamespace()+")";
-              }
+          ti << strings.index(name);
 
-              ti << "'" << name << "'";
+          prevScope = scope;
+          childCount++;
+        }
 
-              prevScope = scope;
-              childCount++;
-            }
+        ti << "]]";
+      }
+      ti << "]";
+    }
+    if (!firstEntry)
+    {
+      ti << endl;
+    }
+    ti << "]";
+  }
+  FTextStream t(&dataOutFile);
+  t << "addSearchData(";
+  strings.write(t);
+  t << "," << endl;
+  t << data.data();
+  t << ");" << endl;
+}
 
-            ti << "]]";
-          }
-          ti << "]";
-          itemCount++;
+void writeJavascriptSearchIndex()
+{
+  int i;
+  // write index files
+  QCString searchDirName = Config_getString("HTML_OUTPUT")+"/search";
+
+  for (i=0;i<NUM_SEARCH_INDICES;i++) // for each index
+  {
+    SIntDict<SearchIndexList>::Iterator it(g_searchIndexInfo[i].symbolList);
+    SearchIndexList *sl;
+    int p=0;
+    for (it.toFirst();(sl=it.current());++it,++p) // for each letter
+    {
+      QCString baseName;
+      baseName.sprintf("%s_%x",g_searchIndexInfo[i].name.data(),p);
+
+      // split the entries for this letter into parts of limited size
+      QList<SearchDefinitionList> items;
+      SDict<SearchDefinitionList>::Iterator li(*sl);
+      SearchDefinitionList *dl;
+      for (li.toFirst();(dl=li.current());++li)
+      {
+        items.append(dl);
+      }
+      QList<SearchShard> shards;
+      shards.setAutoDelete(TRUE);
+      splitSearchShards("",items,shards);
+
+      QCString fileName = searchDirName + "/"+baseName+".html";
+
+      QFile outFile(fileName);
+      if (outFile.open(IO_WriteOnly))
+      {
+        FTextStream t(&outFile);
+
+        t << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\""
+          " \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">" << endl;
+        t << "<html><head><title></title>" << endl;
+        t << "<meta http-equiv=\"Content-Type\" content=\"text/xhtml;charset=UTF-8\"/>" << endl;
+        t << "<meta name=\"generator\" content=\"Doxygen " << versionString << "\"/>" << endl;
+        t << "<link rel=\"stylesheet\" type=\"text/css\" href=\"search.css\"/>" << endl;
+        t << "<script type=\"text/javascript\" src=\"search.js\"></script>" << endl;
+        // only the parts of the index that can match the search term are loaded
+        t << "<script type=\"text/javascript\"><!--" << endl;
+        t << "var searchData=[];" << endl;
+        t << "loadSearchData('" << baseName << "',[";
+        QListIterator<SearchShard> si(shards);
+        SearchShard *shard;
+        for (si.toFirst();(shard=si.current());++si)
+        {
+          if (shard!=shards.getFirst()) t << ",";
+          t << "'" << shard->prefix << "'";
         }
-        if (!firstEntry)
+        t << "]);" << endl;
+        t << "--></script>" << endl;
+        t << "</head>" << endl;
+        t << "<body class=\"SRPage\">" << endl;
+        t << "<div id=\"SRIndex\">" << endl;
+        t << "<div class=\"SRStatus\" id=\"Loading\">" << theTranslator->trLoading() << "</div>" << endl;
+        t << "<div id=\"SRResults\"></div>" << endl; // here the results will be inserted
+        t << "<script type=\"text/javascript\"><!--" << endl;
+        t << "createResults();" << endl; // this function will insert the results
+        t << "--></script>" << endl;
+        t << "<div class=\"SRStatus\" id=\"Searching\">" 
+          << theTranslator->trSearching() << "</div>" << endl;
+        t << "<div class=\"SRStatus\" id=\"NoMatches\">"
+          << theTranslator->trNoMatches() << "</div>" << endl;
+
+        t << "<script type=\"text/javascript\"><!--" << endl;
+        t << "document.getElementById(\"Loading\").style.display=\"none\";" << endl;
+        t << "document.getElementById(\"NoMatches\").style.display=\"none\";" << endl;
+        t << "var searchResults = new SearchResults(\"searchResults\");" << endl;
+        t << "searchResults.Search();" << endl;
+        t << "--></script>" << endl;
+        t << "</div>" << endl; // SRIndex
+        t << "</body>" << endl;
+        t << "</html>" << endl;
+
+        int s=0;
+        for (si.toFirst();(shard=si.current());++si,++s)
         {
-          ti << endl;
+          QCString dataFileName;
+          dataFileName.sprintf("%s/%s_%x.js",searchDirName.data(),baseName.data(),s);
+          writeSearchShard(dataFileName,shard);
         }
-
-        ti << "];" << endl;
-
       }
       else
       {
@@ -28,6 +28,8 @@
 #include "util.h"
 
 class FTextStream;
+class QFile;
+struct SearchPostingRun;
 class Definition;
 class MemberDef;
 
@@ -46,24 +48,26 @@ struct URL
 };
 
 
-struct URLInfo
+/** A word occurring in a document, as collected by SearchIndex */
+struct SearchPosting
 {
-  URLInfo(int idx,int f) : urlIdx(idx), freq(f) {}
-  int urlIdx;
-  int freq;
+  uint wordId;  // id of the IndexWord
+  int  urlIdx;  // index of the document
+  int  freq;    // twice the number of occurrences, lowest bit set for high priority
 };
 
 class IndexWord
 {
   public:
-    IndexWord(const char *word);
-    void addUrlIndex(int,bool);
-    const QIntDict<URLInfo> &urls() const { return m_urls; }
+    IndexWord(const char *word,uint id) : m_word(word), m_id(id), m_lastPos(0) {}
     QCString word() const { return m_word; }
+    uint id() const { return m_id; }
 
   private:
+    friend class SearchIndex;
     QCString    m_word;
-    QIntDict<URLInfo> m_urls;
+    uint        m_id;
+    uint        m_lastPos; // position of the last posting in the posting buffer
 };
 
 class SearchIndexIntf
@@ -84,16 +88,23 @@ class SearchIndex : public SearchIndexIntf
 {
   public:
     SearchIndex();
+   ~SearchIndex();
     void setCurrentDoc(Definition *ctx,const char *anchor,bool isSourceFile);
     void addWord(const char *word,bool hiPriority);
     void write(const char *file);
   private:
     void addWord(const char *word,bool hiPrio,bool recurse);
+    void sortPostings();
+    void spillPostings();
     QDict<IndexWord> m_words;
-    QVector< QList<IndexWord> > m_index;
     QDict<int> m_url2IdMap;
     QIntDict<URL> m_urls;
     int m_urlIndex;
+    SearchPosting *m_postings;
+    uint m_numPostings;
+    QCString m_runFileName;
+    QFile *m_runFile;
+    QList<SearchPostingRun> m_runs;
 };
 
 
@@ -204,9 +204,10 @@ class TagDirInfo
 
 /** Tag file parser. 
  *
- *  Reads an XML-structured tagfile and builds up the structure in
- *  memory. The method buildLists() is used to transfer/translate 
- *  the structures to the doxygen engine.
+ *  Reads an XML-structured tagfile. Each compound is translated into
+ *  an Entry as soon as it has been read, so only the compound that is
+ *  being read is kept in its intermediate form. The method buildLists()
+ *  is used to transfer the entries to the doxygen engine.
  */
 class TagFileParser : public QXmlDefaultHandler
 {
@@ -247,10 +248,12 @@ class TagFileParser : public QXmlDefaultHandler
   public:
     TagFileParser(const char *tagName) : m_startElementHandlers(17),
                                          m_endElementHandlers(17),
+                                         m_strings(1009),
                                          m_tagName(tagName)
     {
       m_startElementHandlers.setAutoDelete(TRUE);
       m_endElementHandlers.setAutoDelete(TRUE);
+      m_strings.setAutoDelete(TRUE);
       m_curClass=0;
       m_curFile=0;
       m_curNamespace=0;
@@ -394,19 +397,36 @@ class TagFileParser : public QXmlDefaultHandler
     {
       switch (m_state)
       {
-        case InClass:     m_tagFileClasses.append(m_curClass); 
+        case InClass:     m_classEntries.append(buildClassEntry(m_curClass));
+                          delete m_curClass;
                           m_curClass=0; break; 
-        case InFile:      m_tagFileFiles.append(m_curFile); 
+        case InFile:      m_fileEntries.append(buildFileEntry(m_curFile));
+                          if (m_curFile->includes.count()>0)
+                          {
+                            // keep the includes until all files are known
+                            m_curFile->members.clear();
+                            m_curFile->docAnchors.clear();
+                            m_tagFileFiles.append(m_curFile);
+                          }
+                          else
+                          {
+                            delete m_curFile;
+                          }
                           m_curFile=0; break; 
-        case InNamespace: m_tagFileNamespaces.append(m_curNamespace); 
+        case InNamespace: m_namespaceEntries.append(buildNamespaceEntry(m_curNamespace));
+                          delete m_curNamespace;
                           m_curNamespace=0; break; 
-        case InGroup:     m_tagFileGroups.append(m_curGroup); 
+        case InGroup:     m_groupEntries.append(buildGroupEntry(m_curGroup));
+                          delete m_curGroup;
                           m_curGroup=0; break; 
-        case InPage:      m_tagFilePages.append(m_curPage); 
+        case InPage:      m_pageEntries.append(buildPageEntry(m_curPage));
+                          delete m_curPage;
                           m_curPage=0; break; 
-        case InDir:       m_tagFileDirs.append(m_curDir);
+        case InDir:       // directories are not imported
+                          delete m_curDir;
                           m_curDir=0; break;
-        case InPackage:   m_tagFilePackages.append(m_curPackage); 
+        case InPackage:   m_packageEntries.append(buildPackageEntry(m_curPackage));
+                          delete m_curPackage;
                           m_curPackage=0; break; 
         default:
                           warn("tag `compound' was not expected!\n");
@@ -416,7 +436,7 @@ class TagFileParser : public QXmlDefaultHandler
     void startMember( const QXmlAttributes& attrib)
     {
       m_curMember = new TagMemberInfo;
-      m_curMember->kind = attrib.value("kind").utf8();
+      m_curMember->kind = intern(attrib.value("kind").utf8());
       QCString protStr   = attrib.value("protection").utf8();
       QCString virtStr   = attrib.value("virtualness").utf8();
       QCString staticStr = attrib.value("static").utf8();
@@ -465,7 +485,7 @@ class TagFileParser : public QXmlDefaultHandler
       {
         m_curString = "";
         m_curEnumValue = new TagEnumValueInfo;
-        m_curEnumValue->file = attrib.value("file").utf8();
+        m_curEnumValue->file = intern(attrib.value("file").utf8());
         m_curEnumValue->anchor = attrib.value("anchor").utf8();
         m_curEnumValue->clangid = attrib.value("clangid").utf8();
         m_stateStack.push(new State(m_state));
@@ -564,7 +584,7 @@ class TagFileParser : public QXmlDefaultHandler
 
     void startDocAnchor(const QXmlAttributes& attrib )
     {
-      m_fileName = attrib.value("file").utf8();
+      m_fileName = intern(attrib.value("file").utf8());
       m_title = attrib.value("title").utf8();
       m_curString = "";
     }
@@ -746,7 +766,7 @@ class TagFileParser : public QXmlDefaultHandler
     {
       if (m_state==InMember)
       {
-        m_curMember->anchorFile = m_curString; 
+        m_curMember->anchorFile = intern(m_curString);
       }
       else
       {
@@ -808,13 +828,7 @@ class TagFileParser : public QXmlDefaultHandler
       m_curDir=0;
 
       m_stateStack.setAutoDelete(TRUE);
-      m_tagFileClasses.setAutoDelete(TRUE);
       m_tagFileFiles.setAutoDelete(TRUE);
-      m_tagFileNamespaces.setAutoDelete(TRUE);
-      m_tagFileGroups.setAutoDelete(TRUE);
-      m_tagFilePages.setAutoDelete(TRUE);
-      m_tagFilePackages.setAutoDelete(TRUE);
-      m_tagFileDirs.setAutoDelete(TRUE);
 
       m_startElementHandlers.insert("compound",    new StartElementHandler(this,&TagFileParser::startCompound));
       m_startElementHandlers.insert("member",      new StartElementHandler(this,&TagFileParser::startMember));
@@ -904,22 +918,42 @@ class TagFileParser : public QXmlDefaultHandler
       return TRUE;
     }
 
-    void dump();
     void buildLists(Entry *root);
     void addIncludes();
     
   private:
+    Entry *buildClassEntry(TagClassInfo *tci);
+    Entry *buildFileEntry(TagFileInfo *tfi);
+    Entry *buildNamespaceEntry(TagNamespaceInfo *tni);
+    Entry *buildPackageEntry(TagPackageInfo *tpgi);
+    Entry *buildGroupEntry(TagGroupInfo *tgi);
+    Entry *buildPageEntry(TagPageInfo *tpi);
     void buildMemberList(Entry *ce,QList<TagMemberInfo> &members);
     void addDocAnchors(Entry *e,const TagAnchorInfoList &l);
-    QList<TagClassInfo>        m_tagFileClasses;
-    QList<TagFileInfo>         m_tagFileFiles;
-    QList<TagNamespaceInfo>    m_tagFileNamespaces;
-    QList<TagGroupInfo>        m_tagFileGroups;
-    QList<TagPageInfo>         m_tagFilePages;
-    QList<TagPackageInfo>      m_tagFilePackages;
-    QList<TagDirInfo>          m_tagFileDirs;
+
+    /** Returns a copy of \a s that shares its data with earlier strings
+     *  having the same value. Used for values that repeat for many members,
+     *  like the file that contains the member's documentation.
+     */
+    QCString intern(const QCString &s)
+    {
+      if (s.isEmpty()) return s;
+      QCString *ps = m_strings.find(s);
+      if (ps) return *ps;
+      m_strings.insert(s,new QCString(s));
+      return s;
+    }
+
+    QList<Entry>               m_classEntries;
+    QList<Entry>               m_fileEntries;
+    QList<Entry>               m_namespaceEntries;
+    QList<Entry>               m_packageEntries;
+    QList<Entry>               m_groupEntries;
+    QList<Entry>               m_pageEntries;
+    QList<TagFileInfo>         m_tagFileFiles;  // files with includes
     QDict<StartElementHandler> m_startElementHandlers;
     QDict<EndElementHandler>   m_endElementHandlers;
+    QDict<QCString>            m_strings;
     TagClassInfo              *m_curClass;
     TagFileInfo               *m_curFile;
     TagNamespaceInfo          *m_curNamespace;
@@ -969,177 +1003,6 @@ class TagFileErrorHandler : public QXmlErrorHandler
     QString errorMsg;
 };
 
-/*! Dumps the internal structures. For debugging only! */
-void TagFileParser::dump()
-{
-  msg("Result:\n");
-  QListIterator<TagClassInfo> lci(m_tagFileClasses);
-
-  //============== CLASSES
-  TagClassInfo *cd;
-  for (;(cd=lci.current());++lci)
-  {
-    msg("class `%s'\n",cd->name.data());
-    msg("  filename `%s'\n",cd->filename.data());
-    if (cd->bases)
-    {
-      QListIterator<BaseInfo> bii(*cd->bases);
-      BaseInfo *bi;
-      for ( bii.toFirst() ; (bi=bii.current()) ; ++bii) 
-      {
-        msg( "  base: %s \n", bi->name.data() );
-      }
-    }
-
-    QListIterator<TagMemberInfo> mci(cd->members);
-    TagMemberInfo *md;
-    for (;(md=mci.current());++mci)
-    {
-      msg("  member:\n");
-      msg("    kind: `%s'\n",md->kind.data());
-      msg("    name: `%s'\n",md->name.data());
-      msg("    anchor: `%s'\n",md->anchor.data());
-      msg("    arglist: `%s'\n",md->arglist.data());
-    }
-  }
-  //============== NAMESPACES
-  QListIterator<TagNamespaceInfo> lni(m_tagFileNamespaces);
-  TagNamespaceInfo *nd;
-  for (;(nd=lni.current());++lni)
-  {
-    msg("namespace `%s'\n",nd->name.data());
-    msg("  filename `%s'\n",nd->filename.data());
-    QStringList::Iterator it;
-    for ( it = nd->classList.begin(); 
-        it != nd->classList.end(); ++it ) 
-    {
-      msg( "  class: %s \n", (*it).latin1() );
-    }
-
-    QListIterator<TagMemberInfo> mci(nd->members);
-    TagMemberInfo *md;
-    for (;(md=mci.current());++mci)
-    {
-      msg("  member:\n");
-      msg("    kind: `%s'\n",md->kind.data());
-      msg("    name: `%s'\n",md->name.data());
-      msg("    anchor: `%s'\n",md->anchor.data());
-      msg("    arglist: `%s'\n",md->arglist.data());
-    }
-  }
-  //============== FILES
-  QListIterator<TagFileInfo> lfi(m_tagFileFiles);
-  TagFileInfo *fd;
-  for (;(fd=lfi.current());++lfi)
-  {
-    msg("file `%s'\n",fd->name.data());
-    msg("  filename `%s'\n",fd->filename.data());
-    QStringList::Iterator it;
-    for ( it = fd->namespaceList.begin(); 
-        it != fd->namespaceList.end(); ++it ) 
-    {
-      msg( "  namespace: %s \n", (*it).latin1() );
-    }
-    for ( it = fd->classList.begin(); 
-        it != fd->classList.end(); ++it ) 
-    {
-      msg( "  class: %s \n", (*it).latin1() );
-    }
-
-    QListIterator<TagMemberInfo> mci(fd->members);
-    TagMemberInfo *md;
-    for (;(md=mci.current());++mci)
-    {
-      msg("  member:\n");
-      msg("    kind: `%s'\n",md->kind.data());
-      msg("    name: `%s'\n",md->name.data());
-      msg("    anchor: `%s'\n",md->anchor.data());
-      msg("    arglist: `%s'\n",md->arglist.data());
-    }
-
-    QListIterator<TagIncludeInfo> mii(fd->includes);
-    TagIncludeInfo *ii;
-    for (;(ii=mii.current());++mii)
-    {
-      msg("  includes id: %s name: %s\n",ii->id.data(),ii->name.data());
-    }
-  }
-
-  //============== GROUPS
-  QListIterator<TagGroupInfo> lgi(m_tagFileGroups);
-  TagGroupInfo *gd;
-  for (;(gd=lgi.current());++lgi)
-  {
-    msg("group `%s'\n",gd->name.data());
-    msg("  filename `%s'\n",gd->filename.data());
-    QStringList::Iterator it;
-    for ( it = gd->namespaceList.begin(); 
-        it != gd->namespaceList.end(); ++it ) 
-    {
-      msg( "  namespace: %s \n", (*it).latin1() );
-    }
-    for ( it = gd->classList.begin(); 
-        it != gd->classList.end(); ++it ) 
-    {
-      msg( "  class: %s \n", (*it).latin1() );
-    }
-    for ( it = gd->fileList.begin(); 
-        it != gd->fileList.end(); ++it ) 
-    {
-      msg( "  file: %s \n", (*it).latin1() );
-    }
-    for ( it = gd->subgroupList.begin(); 
-        it != gd->subgroupList.end(); ++it ) 
-    {
-      msg( "  subgroup: %s \n", (*it).latin1() );
-    }
-    for ( it = gd->pageList.begin(); 
-        it != gd->pageList.end(); ++it ) 
-    {
-      msg( "  page: %s \n", (*it).latin1() );
-    }
-
-    QListIterator<TagMemberInfo> mci(gd->members);
-    TagMemberInfo *md;
-    for (;(md=mci.current());++mci)
-    {
-      msg("  member:\n");
-      msg("    kind: `%s'\n",md->kind.data());
-      msg("    name: `%s'\n",md->name.data());
-      msg("    anchor: `%s'\n",md->anchor.data());
-      msg("    arglist: `%s'\n",md->arglist.data());
-    }
-  }
-  //============== PAGES
-  QListIterator<TagPageInfo> lpi(m_tagFilePages);
-  TagPageInfo *pd;
-  for (;(pd=lpi.current());++lpi)
-  {
-    msg("page `%s'\n",pd->name.data());
-    msg("  title `%s'\n",pd->title.data());
-    msg("  filename `%s'\n",pd->filename.data());
-  }
-  //============== DIRS
-  QListIterator<TagDirInfo> ldi(m_tagFileDirs);
-  TagDirInfo *dd;
-  for (;(dd=ldi.current());++ldi)
-  {
-    msg("dir `%s'\n",dd->name.data());
-    msg("  path `%s'\n",dd->path.data());
-    QStringList::Iterator it;
-    for ( it = dd->fileList.begin(); 
-        it != dd->fileList.end(); ++it ) 
-    {
-      msg( "  file: %s \n", (*it).latin1() );
-    }
-    for ( it = dd->subdirList.begin(); 
-        it != dd->subdirList.end(); ++it ) 
-    {
-      msg( "  subdir: %s \n", (*it).latin1() );
-    }
-  }
-}
-
 void TagFileParser::addDocAnchors(Entry *e,const TagAnchorInfoList &l)
 {
   QListIterator<TagAnchorInfo> tli(l);
@@ -1297,183 +1160,183 @@ static QCString stripPath(const QCString &s)
   }
 }
 
-/*! Injects the info gathered by the XML parser into the Entry tree.
- *  This tree contains the information extracted from the input in a 
- *  "unrelated" form.
- */
-void TagFileParser::buildLists(Entry *root)
+Entry *TagFileParser::buildClassEntry(TagClassInfo *tci)
 {
-  // build class list
-  QListIterator<TagClassInfo> cit(m_tagFileClasses);
-  TagClassInfo *tci;
-  for (cit.toFirst();(tci=cit.current());++cit)
+  Entry *ce = new Entry;
+  ce->section = Entry::CLASS_SEC;
+  switch (tci->kind)
   {
-    Entry *ce = new Entry;
-    ce->section = Entry::CLASS_SEC;
-    switch (tci->kind)
-    {
-      case TagClassInfo::Class:     break;
-      case TagClassInfo::Struct:    ce->spec = Entry::Struct;    break;
-      case TagClassInfo::Union:     ce->spec = Entry::Union;     break;
-      case TagClassInfo::Interface: ce->spec = Entry::Interface; break;
-      case TagClassInfo::Enum:      ce->spec = Entry::Enum;      break;
-      case TagClassInfo::Exception: ce->spec = Entry::Exception; break;
-      case TagClassInfo::Protocol:  ce->spec = Entry::Protocol;  break;
-      case TagClassInfo::Category:  ce->spec = Entry::Category;  break;
-      case TagClassInfo::Service:   ce->spec = Entry::Service;   break;
-      case TagClassInfo::Singleton: ce->spec = Entry::Singleton; break;
-    }
-    ce->name     = tci->name;
-    if (tci->kind==TagClassInfo::Protocol)
-    {
-      ce->name+="-p";
-    }
-    addDocAnchors(ce,tci->docAnchors);
-    TagInfo *ti  = new TagInfo;
-    ti->tagName  = m_tagName;
-    ti->fileName = tci->filename;
-    ce->id       = tci->clangId;
-    ce->tagInfo  = ti;
-    ce->lang     = tci->isObjC ? SrcLangExt_ObjC : SrcLangExt_Unknown;
-    // transfer base class list
-    if (tci->bases)
-    {
-      delete ce->extends;
-      ce->extends = tci->bases; tci->bases = 0;
-    }
-    if (tci->templateArguments)
-    {
-      if (ce->tArgLists==0)
-      {
-        ce->tArgLists = new QList<ArgumentList>;
-        ce->tArgLists->setAutoDelete(TRUE);
-      }
-      ArgumentList *al = new ArgumentList;
-      ce->tArgLists->append(al);
-
-      QListIterator<QCString> sli(*tci->templateArguments);
-      QCString *argName;
-      for (;(argName=sli.current());++sli)
-      {
-        Argument *a = new Argument;
-        a->type = "class";
-        a->name = *argName;
-        al->append(a);
-      }
-    }
-
-    buildMemberList(ce,tci->members);
-    root->addSubEntry(ce);
+    case TagClassInfo::Class:     break;
+    case TagClassInfo::Struct:    ce->spec = Entry::Struct;    break;
+    case TagClassInfo::Union:     ce->spec = Entry::Union;     break;
+    case TagClassInfo::Interface: ce->spec = Entry::Interface; break;
+    case TagClassInfo::Enum:      ce->spec = Entry::Enum;      break;
+    case TagClassInfo::Exception: ce->spec = Entry::Exception; break;
+    case TagClassInfo::Protocol:  ce->spec = Entry::Protocol;  break;
+    case TagClassInfo::Category:  ce->spec = Entry::Category;  break;
+    case TagClassInfo::Service:   ce->spec = Entry::Service;   break;
+    case TagClassInfo::Singleton: ce->spec = Entry::Singleton; break;
   }
-
-  // build file list
-  QListIterator<TagFileInfo> fit(m_tagFileFiles);
-  TagFileInfo *tfi;
-  for (fit.toFirst();(tfi=fit.current());++fit)
+  ce->name     = tci->name;
+  if (tci->kind==TagClassInfo::Protocol)
   {
-    Entry *fe = new Entry;
-    fe->section = guessSection(tfi->name);
-    fe->name     = tfi->name;
-    addDocAnchors(fe,tfi->docAnchors);
-    TagInfo *ti  = new TagInfo;
-    ti->tagName  = m_tagName;
-    ti->fileName = tfi->filename;
-    fe->tagInfo  = ti;
-    
-    QCString fullName = m_tagName+":"+tfi->path+stripPath(tfi->name);
-    fe->fileName = fullName;
-    //printf("new FileDef() filename=%s\n",tfi->filename.data());
-    FileDef *fd = new FileDef(m_tagName+":"+tfi->path,
-                              tfi->name,m_tagName,
-                              tfi->filename
-                             );
-    FileName *mn;
-    if ((mn=Doxygen::inputNameDict->find(tfi->name)))
-    {
-      mn->append(fd);
+    ce->name+="-p";
+  }
+  addDocAnchors(ce,tci->docAnchors);
+  TagInfo *ti  = new TagInfo;
+  ti->tagName  = m_tagName;
+  ti->fileName = tci->filename;
+  ce->id       = tci->clangId;
+  ce->tagInfo  = ti;
+  ce->lang     = tci->isObjC ? SrcLangExt_ObjC : SrcLangExt_Unknown;
+  // transfer base class list
+  if (tci->bases)
+  {
+    delete ce->extends;
+    ce->extends = tci->bases; tci->bases = 0;
+  }
+  if (tci->templateArguments)
+  {
+    if (ce->tArgLists==0)
+    {
+      ce->tArgLists = new QList<ArgumentList>;
+      ce->tArgLists->setAutoDelete(TRUE);
     }
-    else
+    ArgumentList *al = new ArgumentList;
+    ce->tArgLists->append(al);
+
+    QListIterator<QCString> sli(*tci->templateArguments);
+    QCString *argName;
+    for (;(argName=sli.current());++sli)
     {
-      mn = new FileName(fullName,tfi->name);
-      mn->append(fd);
-      Doxygen::inputNameList->inSort(mn);
-      Doxygen::inputNameDict->insert(tfi->name,mn);
+      Argument *a = new Argument;
+      a->type = "class";
+      a->name = *argName;
+      al->append(a);
     }
-    buildMemberList(fe,tfi->members);
-    root->addSubEntry(fe);
   }
 
-  // build namespace list
-  QListIterator<TagNamespaceInfo> nit(m_tagFileNamespaces);
-  TagNamespaceInfo *tni;
-  for (nit.toFirst();(tni=nit.current());++nit)
-  {
-    Entry *ne    = new Entry;
-    ne->section  = Entry::NAMESPACE_SEC;
-    ne->name     = tni->name;
-    addDocAnchors(ne,tni->docAnchors);
-    TagInfo *ti  = new TagInfo;
-    ti->tagName  = m_tagName;
-    ti->fileName = tni->filename;
-    ne->id       = tni->clangId;
-    ne->tagInfo  = ti;
-
-    buildMemberList(ne,tni->members);
-    root->addSubEntry(ne);
-  }
+  buildMemberList(ce,tci->members);
+  return ce;
+}
 
-  // build package list
-  QListIterator<TagPackageInfo> pit(m_tagFilePackages);
-  TagPackageInfo *tpgi;
-  for (pit.toFirst();(tpgi=pit.current());++pit)
+Entry *TagFileParser::buildFileEntry(TagFileInfo *tfi)
+{
+  Entry *fe = new Entry;
+  fe->section = guessSection(tfi->name);
+  fe->name     = tfi->name;
+  addDocAnchors(fe,tfi->docAnchors);
+  TagInfo *ti  = new TagInfo;
+  ti->tagName  = m_tagName;
+  ti->fileName = tfi->filename;
+  fe->tagInfo  = ti;
+  
+  QCString fullName = m_tagName+":"+tfi->path+stripPath(tfi->name);
+  fe->fileName = fullName;
+  //printf("new FileDef() filename=%s\n",tfi->filename.data());
+  FileDef *fd = new FileDef(m_tagName+":"+tfi->path,
+                            tfi->name,m_tagName,
+                            tfi->filename
+                           );
+  FileName *mn;
+  if ((mn=Doxygen::inputNameDict->find(tfi->name)))
   {
-    Entry *pe    = new Entry;
-    pe->section  = Entry::PACKAGE_SEC;
-    pe->name     = tpgi->name;
-    addDocAnchors(pe,tpgi->docAnchors);
-    TagInfo *ti  = new TagInfo;
-    ti->tagName  = m_tagName;
-    ti->fileName = tpgi->filename;
-    pe->tagInfo  = ti;
-
-    buildMemberList(pe,tpgi->members);
-    root->addSubEntry(pe);
+    mn->append(fd);
   }
-
-  // build group list
-  QListIterator<TagGroupInfo> git(m_tagFileGroups);
-  TagGroupInfo *tgi;
-  for (git.toFirst();(tgi=git.current());++git)
+  else
   {
-    Entry *ge    = new Entry;
-    ge->section  = Entry::GROUPDOC_SEC;
-    ge->name     = tgi->name;
-    ge->type     = tgi->title;
-    addDocAnchors(ge,tgi->docAnchors);
-    TagInfo *ti  = new TagInfo;
-    ti->tagName  = m_tagName;
-    ti->fileName = tgi->filename;
-    ge->tagInfo  = ti;
-
-    buildMemberList(ge,tgi->members);
-    root->addSubEntry(ge);
+    mn = new FileName(fullName,tfi->name);
+    mn->append(fd);
+    Doxygen::inputNameList->inSort(mn);
+    Doxygen::inputNameDict->insert(tfi->name,mn);
   }
+  buildMemberList(fe,tfi->members);
+  return fe;
+}
+
+Entry *TagFileParser::buildNamespaceEntry(TagNamespaceInfo *tni)
+{
+  Entry *ne    = new Entry;
+  ne->section  = Entry::NAMESPACE_SEC;
+  ne->name     = tni->name;
+  addDocAnchors(ne,tni->docAnchors);
+  TagInfo *ti  = new TagInfo;
+  ti->tagName  = m_tagName;
+  ti->fileName = tni->filename;
+  ne->id       = tni->clangId;
+  ne->tagInfo  = ti;
+
+  buildMemberList(ne,tni->members);
+  return ne;
+}
+
+Entry *TagFileParser::buildPackageEntry(TagPackageInfo *tpgi)
+{
+  Entry *pe    = new Entry;
+  pe->section  = Entry::PACKAGE_SEC;
+  pe->name     = tpgi->name;
+  addDocAnchors(pe,tpgi->docAnchors);
+  TagInfo *ti  = new TagInfo;
+  ti->tagName  = m_tagName;
+  ti->fileName = tpgi->filename;
+  pe->tagInfo  = ti;
+
+  buildMemberList(pe,tpgi->members);
+  return pe;
+}
 
-  // build page list
-  QListIterator<TagPageInfo> pgit(m_tagFilePages);
-  TagPageInfo *tpi;
-  for (pgit.toFirst();(tpi=pgit.current());++pgit)
+Entry *TagFileParser::buildGroupEntry(TagGroupInfo *tgi)
+{
+  Entry *ge    = new Entry;
+  ge->section  = Entry::GROUPDOC_SEC;
+  ge->name     = tgi->name;
+  ge->type     = tgi->title;
+  addDocAnchors(ge,tgi->docAnchors);
+  TagInfo *ti  = new TagInfo;
+  ti->tagName  = m_tagName;
+  ti->fileName = tgi->filename;
+  ge->tagInfo  = ti;
+
+  buildMemberList(ge,tgi->members);
+  return ge;
+}
+
+Entry *TagFileParser::buildPageEntry(TagPageInfo *tpi)
+{
+  Entry *pe    = new Entry;
+  pe->section  = tpi->filename=="index" ? Entry::MAINPAGEDOC_SEC : Entry::PAGEDOC_SEC;
+  pe->name     = tpi->name;
+  pe->args     = tpi->title;
+  addDocAnchors(pe,tpi->docAnchors);
+  TagInfo *ti  = new TagInfo;
+  ti->tagName  = m_tagName;
+  ti->fileName = tpi->filename;
+  pe->tagInfo  = ti;
+  return pe;
+}
+
+/*! Injects the entries built from the tag file into the Entry tree.
+ *  This tree contains the information extracted from the input in a 
+ *  "unrelated" form.
+ */
+void TagFileParser::buildLists(Entry *root)
+{
+  // the entries are added grouped by kind, in the order they were read
+  QList<Entry> *lists[] =
   {
-    Entry *pe    = new Entry;
-    pe->section  = tpi->filename=="index" ? Entry::MAINPAGEDOC_SEC : Entry::PAGEDOC_SEC;
-    pe->name     = tpi->name;
-    pe->args     = tpi->title;
-    addDocAnchors(pe,tpi->docAnchors);
-    TagInfo *ti  = new TagInfo;
-    ti->tagName  = m_tagName;
-    ti->fileName = tpi->filename;
-    pe->tagInfo  = ti;
-    root->addSubEntry(pe);
+    &m_classEntries, &m_fileEntries, &m_namespaceEntries,
+    &m_packageEntries, &m_groupEntries, &m_pageEntries
+  };
+  uint i;
+  for (i=0;i<sizeof(lists)/sizeof(lists[0]);i++)
+  {
+    QListIterator<Entry> eli(*lists[i]);
+    Entry *e;
+    for (;(e=eli.current());++eli)
+    {
+      root->addSubEntry(e);
+    }
+    lists[i]->clear();
   }
 }
 
@@ -1539,7 +1402,6 @@ void parseTagFile(Entry *root,const char *fullName)
   reader.parse( source );
   handler.buildLists(root);
   handler.addIncludes();
-  //handler.dump();
 }
 
 
@@ -28,12 +28,14 @@
 #include <qregexp.h>
 #include <qcstring.h>
 #include <qdir.h>
+#include <qbuffer.h>
 
 #include "sortdict.h"
 #include "ftextstream.h"
 #include "message.h"
 #include "util.h"
 #include "resourcemgr.h"
+#include "outputgen.h"
 
 #define ENABLE_TRACING 0
 
@@ -506,6 +508,23 @@ struct TemplateKeyValue
   TemplateVariant value;
 };
 
+/** @brief One part of a dotted variable name like \c member.name.
+ *  Variable names in expressions are split into parts when the template
+ *  is parsed, so resolving them does not scan and copy the name again
+ *  for every page.
+ */
+struct TemplateVariablePart
+{
+  TemplateVariablePart() : index(0), isIndex(FALSE) {}
+  TemplateVariablePart(const QCString &n) : name(n), index(0), isIndex(FALSE)
+  { index = name.toInt(&isIndex); }
+  QCString name;
+  int      index;    // value of name if it is a number (i.e. a list index)
+  bool     isIndex;
+};
+
+typedef QValueList<TemplateVariablePart> TemplateVariablePath;
+
 /** @brief Internal class representing the implementation of a template
  *  context */
 class TemplateContextImpl : public TemplateContext
@@ -537,6 +556,8 @@ class TemplateContextImpl : public TemplateContext
     // internal methods
     TemplateBlockContext *blockContext();
     TemplateVariant getPrimary(const QCString &name) const;
+    TemplateVariant getPath(const TemplateVariablePath &path) const;
+    static void splitPath(const QCString &name,TemplateVariablePath &path);
     void setLocation(const QCString &templateName,int line)
     { m_templateName=templateName; m_line=line; }
     QCString templateName() const                { return m_templateName; }
@@ -1385,12 +1406,14 @@ class ExprAstVariable : public ExprAst
 {
   public:
     ExprAstVariable(const char *name) : m_name(name)
-    { TRACE(("ExprAstVariable(%s)\n",name)); }
+    { TRACE(("ExprAstVariable(%s)\n",name));
+      TemplateContextImpl::splitPath(m_name,m_path);
+    }
     const QCString &name() const { return m_name; }
     virtual TemplateVariant resolve(TemplateContext *c)
     {
-      TemplateVariant v = c->get(m_name);
       TemplateContextImpl *ci = dynamic_cast<TemplateContextImpl*>(c);
+      TemplateVariant v = ci ? ci->getPath(m_path) : c->get(m_name);
       if (!v.isValid())
       {
         if (ci) ci->warn(ci->templateName(),ci->line(),"undefined variable '%s' in expression",m_name.data());
@@ -1399,6 +1422,7 @@ class ExprAstVariable : public ExprAst
     }
   private:
     QCString m_name;
+    TemplateVariablePath m_path;
 };
 
 class ExprAstFunctionVariable : public ExprAst
@@ -2322,72 +2346,68 @@ void TemplateContextImpl::set(const char *name,const TemplateVariant &v)
   m_contextStack.getFirst()->insert(name,new TemplateVariant(v));
 }
 
+void TemplateContextImpl::splitPath(const QCString &name,TemplateVariablePath &path)
+{
+  int p=0,i;
+  while ((i=name.find('.',p))!=-1)
+  {
+    path.append(TemplateVariablePart(name.mid(p,i-p)));
+    p=i+1;
+  }
+  path.append(TemplateVariablePart(name.mid(p)));
+}
+
 TemplateVariant TemplateContextImpl::get(const QCString &name) const
 {
-  int i=name.find('.');
-  if (i==-1) // simple name
+  if (name.find('.')==-1) // simple name
   {
     return getPrimary(name);
   }
   else // obj.prop
   {
-    QCString objName = name.left(i);
-    TemplateVariant v = getPrimary(objName);
-    QCString propName = name.mid(i+1);
-    while (!propName.isEmpty())
-    {
-      //printf("getPrimary(%s) type=%d:%s\n",objName.data(),v.type(),v.toString().data());
-      if (v.type()==TemplateVariant::Struct)
-      {
-        i = propName.find(".");
-        int l = i==-1 ? propName.length() : i;
-        v = v.toStruct()->get(propName.left(l));
-        if (!v.isValid())
-        {
-          warn(m_templateName,m_line,"requesting non-existing property '%s' for object '%s'",propName.left(l).data(),objName.data());
-        }
-        if (i!=-1)
-        {
-          objName = propName.left(i);
-          propName = propName.mid(i+1);
-        }
-        else
-        {
-          propName.resize(0);
-        }
+    TemplateVariablePath path;
+    splitPath(name,path);
+    return getPath(path);
+  }
+}
+
+TemplateVariant TemplateContextImpl::getPath(const TemplateVariablePath &path) const
+{
+  TemplateVariablePath::ConstIterator it = path.begin();
+  const QCString *objName = &(*it).name; // name of the struct v was taken from
+  TemplateVariant v = getPrimary(*objName);
+  for (++it;it!=path.end();++it)
+  {
+    const TemplateVariablePart &part = *it;
+    //printf("getPath(%s) type=%d:%s\n",part.name.data(),v.type(),v.toString().data());
+    if (v.type()==TemplateVariant::Struct)
+    {
+      v = v.toStruct()->get(part.name);
+      if (!v.isValid())
+      {
+        warn(m_templateName,m_line,"requesting non-existing property '%s' for object '%s'",part.name.data(),objName->data());
       }
-      else if (v.type()==TemplateVariant::List)
+      objName = &part.name;
+    }
+    else if (v.type()==TemplateVariant::List)
+    {
+      if (part.isIndex)
       {
-        i = propName.find(".");
-        int l = i==-1 ? propName.length() : i;
-        bool b;
-        int index = propName.left(l).toInt(&b);
-        if (b)
-        {
-          v = v.toList()->at(index);
-        }
-        else
-        {
-          warn(m_templateName,m_line,"list index '%s' is not valid",propName.data());
-          break;
-        }
-        if (i!=-1)
-        {
-          propName = propName.mid(i+1);
-        }
-        else
-        {
-          propName.resize(0);
-        }
+        v = v.toList()->at(part.index);
       }
       else
       {
-        warn(m_templateName,m_line,"using . on an object '%s' is not an struct or list",objName.data());
-        return TemplateVariant();
+        warn(m_templateName,m_line,"list index '%s' is not valid",part.name.data());
+        break;
       }
     }
-    return v;
+    else
+    {
+      warn(m_templateName,m_line,"using . on an object '%s' is not an struct or list",objName->data());
+      return TemplateVariant();
+    }
   }
+  return v;
 }
 
 const TemplateVariant *TemplateContextImpl::getRef(const QCString &name) const
@@ -3554,24 +3574,28 @@ class TemplateNodeCreate : public TemplateNodeCreator<TemplateNodeCreate>
                 outputFile.prepend(ci->outputDirectory()+"/");
               }
               //printf("NoteCreate(%s)\n",outputFile.data());
-              QFile f(outputFile);
-              if (f.open(IO_WriteOnly))
+              if (OutputFileWriter::isActive())
               {
-                TemplateEscapeIntf *escIntf = ci->escapeIntf();
-                ci->selectEscapeIntf(extension);
-                FTextStream ts(&f);
-                QGString out;
-                FTextStream os(&out);
-                createTemplate->render(os,c);
-                stripLeadingWhiteSpace(out);
-                ts << out;
-                t->engine()->unload(t);
-                ci->setActiveEscapeIntf(escIntf);
+                // render the page in memory, one of the writer threads
+                // stores it while the next page is rendered
+                QBuffer *buf = new QBuffer;
+                buf->open(IO_WriteOnly);
+                renderPage(buf,ci,createTemplate,extension);
+                OutputFileWriter::enqueue(outputFile,buf);
               }
               else
               {
-                ci->warn(m_templateName,m_line,"failed to open output file '%s' for create command",outputFile.data());
+                QFile f(outputFile);
+                if (f.open(IO_WriteOnly))
+                {
+                  renderPage(&f,ci,createTemplate,extension);
+                }
+                else
+                {
+                  ci->warn(m_templateName,m_line,"failed to open output file '%s' for create command",outputFile.data());
+                }
               }
+              t->engine()->unload(t);
             }
             else
             {
@@ -3584,6 +3608,19 @@ class TemplateNodeCreate : public TemplateNodeCreator<TemplateNodeCreate>
     }
 
   private:
+    void renderPage(QIODevice *dev,TemplateContextImpl *ci,TemplateImpl *createTemplate,
+                    const QCString &extension)
+    {
+      TemplateEscapeIntf *escIntf = ci->escapeIntf();
+      ci->selectEscapeIntf(extension);
+      QGString out;
+      FTextStream os(&out);
+      createTemplate->render(os,ci);
+      stripLeadingWhiteSpace(out);
+      dev->writeBlock(out.data(),out.length());
+      ci->setActiveEscapeIntf(escIntf);
+    }
+
     ExprAst *m_templateExpr;
     ExprAst *m_fileExpr;
 };
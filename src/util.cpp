@@ -27,6 +27,7 @@
 #include <qdir.h>
 #include <qdatetime.h>
 #include <qcache.h>
+#include <qthread.h>
 
 #include "util.h"
 #include "message.h"
@@ -62,6 +63,7 @@
 #include "membergroup.h"
 #include "dirdef.h"
 #include "htmlentity.h"
+#include "lookupcache.h"
 
 #define ENABLE_TRACINGSUPPORT 0
 
@@ -1438,59 +1440,34 @@ static ClassDef *getResolvedClassRec(Definition *scope,
   // Since it is often the case that the same name is searched in the same
   // scope over an over again (especially for the linked source code generation)
   // we use a cache to collect previous results. This is possible since the
-  // result of a lookup is deterministic. As the key we use the concatenated
-  // scope, the name to search for and the explicit scope prefix. The speedup
+  // result of a lookup is deterministic. As the key we use the scope, the
+  // name to search for and the explicit scope prefix. The speedup
   // achieved by this simple cache can be enormous.
-  int scopeNameLen = scope->name().length()+1;
-  int nameLen = name.length()+1;
-  int explicitPartLen = explicitScopePart.length();
-  int fileScopeLen = hasUsingStatements ? 1+fileScope->absFilePath().length() : 0;
-
-  // below is a more efficient coding of
-  // QCString key=scope->name()+"+"+name+"+"+explicitScopePart;
-  QCString key(scopeNameLen+nameLen+explicitPartLen+fileScopeLen+1);
-  char *p=key.rawData();
-  qstrcpy(p,scope->name()); *(p+scopeNameLen-1)='+';
-  p+=scopeNameLen;
-  qstrcpy(p,name); *(p+nameLen-1)='+';
-  p+=nameLen;
-  qstrcpy(p,explicitScopePart);
-  p+=explicitPartLen;
-
+  //
   // if a file scope is given and it contains using statements we should
-  // also use the file part in the key (as a class name can be in
+  // also use the file in the key (as a class name can be in
   // two different namespaces and a using statement in a file can select 
   // one of them).
-  if (hasUsingStatements)
-  {
-    // below is a more efficient coding of
-    // key+="+"+fileScope->name();
-    *p++='+';
-    qstrcpy(p,fileScope->absFilePath());
-    p+=fileScopeLen-1;
-  }
-  *p='\0';
-
-  LookupInfo *pval=Doxygen::lookupCache->find(key);
-  //printf("Searching for %s result=%p\n",key.data(),pval);
-  if (pval)
+  LookupKey key(scope,hasUsingStatements ? fileScope : 0,name,explicitScopePart);
+  LookupInfo cached;
+  if (Doxygen::lookupCache->find(key,cached))
   {
     //printf("LookupInfo %p %p '%s' %p\n", 
-    //    pval->classDef, pval->typeDef, pval->templSpec.data(), 
-    //    pval->resolvedType.data()); 
-    if (pTemplSpec)    *pTemplSpec=pval->templSpec;
-    if (pTypeDef)      *pTypeDef=pval->typeDef;
-    if (pResolvedType) *pResolvedType=pval->resolvedType;
+    //    cached.classDef, cached.typeDef, cached.templSpec.data(), 
+    //    cached.resolvedType.data()); 
+    if (pTemplSpec)    *pTemplSpec=cached.templSpec;
+    if (pTypeDef)      *pTypeDef=cached.typeDef;
+    if (pResolvedType) *pResolvedType=cached.resolvedType;
     //printf("] cachedMatch=%s\n",
-    //    pval->classDef?pval->classDef->name().data():"<none>");
+    //    cached.classDef?cached.classDef->name().data():"<none>");
     //if (pTemplSpec) 
     //  printf("templSpec=%s\n",pTemplSpec->data());
-    return pval->classDef; 
+    return cached.classDef; 
   }
   else // not found yet; we already add a 0 to avoid the possibility of 
     // endless recursion.
   {
-    Doxygen::lookupCache->insert(key,new LookupInfo);
+    Doxygen::lookupCache->insert(key,LookupInfo());
   }
 
   ClassDef *bestMatch=0;
@@ -1502,14 +1479,37 @@ static ClassDef *getResolvedClassRec(Definition *scope,
   if (di->definitionType()==DefinitionIntf::TypeSymbolList) // not a unique name
   {
     //printf("  name is not unique\n");
+    // Definitions imported from tag files are only considered if none of
+    // the local definitions is accessible. With many tag files most
+    // definitions of a common name are external, and checking whether they
+    // are accessible is the costly part of the lookup.
     DefinitionListIterator dli(*(DefinitionList*)di);
     Definition *d;
-    int count=0;
-    for (dli.toFirst();(d=dli.current());++dli,++count) // foreach definition
+    bool hasExternal=FALSE;
+    for (dli.toFirst();(d=dli.current());++dli) // foreach local definition
     {
-      getResolvedSymbol(scope,fileScope,d,explicitScopePart,&actTemplParams,
-                        minDistance,bestMatch,bestTypedef,bestTemplSpec,
-                        bestResolvedType);
+      if (d->isReference())
+      {
+        hasExternal=TRUE;
+      }
+      else
+      {
+        getResolvedSymbol(scope,fileScope,d,explicitScopePart,&actTemplParams,
+                          minDistance,bestMatch,bestTypedef,bestTemplSpec,
+                          bestResolvedType);
+      }
+    }
+    if (hasExternal && bestMatch==0 && bestTypedef==0)
+    {
+      for (dli.toFirst();(d=dli.current());++dli) // foreach external definition
+      {
+        if (d->isReference())
+        {
+          getResolvedSymbol(scope,fileScope,d,explicitScopePart,&actTemplParams,
+                            minDistance,bestMatch,bestTypedef,bestTemplSpec,
+                            bestResolvedType);
+        }
+      }
     }
   }
   else // unique name
@@ -1536,18 +1536,7 @@ static ClassDef *getResolvedClassRec(Definition *scope,
   //printf("getResolvedClassRec: bestMatch=%p pval->resolvedType=%s\n",
   //    bestMatch,bestResolvedType.data());
 
-  pval=Doxygen::lookupCache->find(key);
-  if (pval)
-  {
-    pval->classDef     = bestMatch;
-    pval->typeDef      = bestTypedef;
-    pval->templSpec    = bestTemplSpec;
-    pval->resolvedType = bestResolvedType;
-  }
-  else
-  {
-    Doxygen::lookupCache->insert(key,new LookupInfo(bestMatch,bestTypedef,bestTemplSpec,bestResolvedType));
-  }
+  Doxygen::lookupCache->insert(key,LookupInfo(bestMatch,bestTypedef,bestTemplSpec,bestResolvedType));
   //printf("] bestMatch=%s distance=%d\n",
   //    bestMatch?bestMatch->name().data():"<none>",minDistance);
   //if (pTemplSpec) 
@@ -7673,38 +7662,52 @@ static int transcodeCharacterBuffer(const char *fileName,BufStr &srcBuf,int size
 bool readInputFile(const char *fileName,BufStr &inBuf,bool filter,bool isSourceCode)
 {
   // try to open file
-  int size=0;
-  //uint oldPos = dest.curPos();
-  //printf(".......oldPos=%d\n",oldPos);
-
   QFileInfo fi(fileName);
   if (!fi.exists()) return FALSE;
-  QCString filterName = getFileFilter(fileName,isSourceCode);
-  if (filterName.isEmpty() || !filter)
+  QCString filterName;
+  if (filter)
+  {
+    filterName = getFileFilter(fileName,isSourceCode);
+  }
+  if (!readRawInputFile(fileName,inBuf,filterName)) return FALSE;
+  convertInputBuffer(fileName,inBuf);
+  return TRUE;
+}
+
+/*! Reads the contents of \a fileName into \a inBuf, passing it through
+ *  the input filter \a filterName if that is not empty. The contents
+ *  are not transcoded. This function does not access the configuration,
+ *  and can therefore also be used from a worker thread.
+ *  Errors are only reported if \a reportErrors is TRUE.
+ */
+bool readRawInputFile(const char *fileName,BufStr &inBuf,const char *filterName,
+                      bool reportErrors)
+{
+  if (filterName==0 || filterName[0]=='\0')
   {
     QFile f(fileName);
     if (!f.open(IO_ReadOnly))
     {
-      err("could not open file %s\n",fileName);
+      if (reportErrors) err("could not open file %s\n",fileName);
       return FALSE;
     }
-    size=fi.size();
+    int size=f.size();
     // read the file
     inBuf.skip(size);
     if (f.readBlock(inBuf.data()/*+oldPos*/,size)!=size)
     {
-      err("problems while reading file %s\n",fileName);
+      if (reportErrors) err("problems while reading file %s\n",fileName);
       return FALSE;
     }
   }
   else
   {
-    QCString cmd=filterName+" \""+fileName+"\"";
+    QCString cmd=QCString(filterName)+" \""+fileName+"\"";
     Debug::print(Debug::ExtCmd,0,"Executing popen(`%s`)\n",qPrint(cmd));
     FILE *f=portable_popen(cmd,"r");
     if (!f)
     {
-      err("could not execute filter %s\n",filterName.data());
+      if (reportErrors) err("could not execute filter %s\n",filterName);
       return FALSE;
     }
     const int bufSize=1024;
@@ -7713,15 +7716,23 @@ bool readInputFile(const char *fileName,BufStr &inBuf,bool filter,bool isSourceC
     while ((numRead=(int)fread(buf,1,bufSize,f))>0)
     {
       //printf(">>>>>>>>Reading %d bytes\n",numRead);
-      inBuf.addArray(buf,numRead),size+=numRead;
+      inBuf.addArray(buf,numRead);
     }
     portable_pclose(f);
     inBuf.at(inBuf.curPos()) ='\0';
     Debug::print(Debug::FilterOutput, 0, "Filter output\n");
     Debug::print(Debug::FilterOutput,0,"-------------\n%s\n-------------\n",qPrint(inBuf));
   }
+  return TRUE;
+}
 
+/*! Converts the raw contents of an input file as read by readRawInputFile()
+ *  to UTF-8 with Unix line endings, and terminates the buffer.
+ */
+void convertInputBuffer(const char *fileName,BufStr &inBuf)
+{
   int start=0;
+  int size=inBuf.curPos();
   if (size>=2 &&
       ((inBuf.at(0)==-1 && inBuf.at(1)==-2) || // Litte endian BOM
        (inBuf.at(0)==-2 && inBuf.at(1)==-1)    // big endian BOM
@@ -7758,7 +7769,6 @@ bool readInputFile(const char *fileName,BufStr &inBuf,bool filter,bool isSourceC
     //printf(".......resizing from %d to %d result=[%s]\n",oldPos+size,oldPos+newSize,dest.data());
   }
   inBuf.addChar(0);
-  return TRUE;
 }
 
 // Replace %word by word in title
@@ -7781,13 +7791,38 @@ QCString filterTitle(const QCString &title)
 // returns TRUE if the name of the file represented by `fi' matches
 // one of the file patterns in the `patList' list.
 
+/*! Returns the compiled regular expression for file pattern \a pattern.
+ *  The same pattern lists are matched against every file found in the
+ *  input directories, so each pattern is only converted once.
+ */
+static const QRegExp *compiledFilePattern(const char *pattern)
+{
+  static QDict<QRegExp> cache(257);
+  cache.setAutoDelete(TRUE);
+  QRegExp *re = cache.find(pattern);
+  if (re==0)
+  {
+    QCString pat = pattern;
+    int i=pat.find('=');
+    if (i!=-1) pat=pat.left(i); // strip of the extension specific filter name
+
+#if defined(_WIN32) || defined(__MACOSX__) // Windows or MacOSX
+    re = new QRegExp(pat,FALSE,TRUE); // case insensitive match 
+#else                // unix
+    re = new QRegExp(pat,TRUE,TRUE);  // case sensitive match
+#endif
+    cache.insert(pattern,re);
+  }
+  return re;
+}
+
 bool patternMatch(const QFileInfo &fi,const QStrList *patList)
 {
   bool found=FALSE;
-  if (patList)
+  if (patList && !patList->isEmpty())
   { 
     QStrListIterator it(*patList);
-    QCString pattern;
+    const char *pattern;
 
     QCString fn = fi.fileName().data();
     QCString fp = fi.filePath().data();
@@ -7795,22 +7830,15 @@ bool patternMatch(const QFileInfo &fi,const QStrList *patList)
 
     for (it.toFirst();(pattern=it.current());++it)
     {
-      if (!pattern.isEmpty())
+      if (pattern[0]!='\0')
       {
-        int i=pattern.find('=');
-        if (i!=-1) pattern=pattern.left(i); // strip of the extension specific filter name
-
-#if defined(_WIN32) || defined(__MACOSX__) // Windows or MacOSX
-        QRegExp re(pattern,FALSE,TRUE); // case insensitive match 
-#else                // unix
-        QRegExp re(pattern,TRUE,TRUE);  // case sensitive match
-#endif
-        found = re.match(fn)!=-1 ||
-                re.match(fp)!=-1 ||
-                re.match(afp)!=-1;
+        const QRegExp *re = compiledFilePattern(pattern);
+        found = re->match(fn)!=-1 ||
+                re->match(fp)!=-1 ||
+                re->match(afp)!=-1;
         if (found) break;
         //printf("Matching `%s' against pattern `%s' found=%d\n",
-        //    fi->fileName().data(),pattern.data(),found);
+        //    fi->fileName().data(),pattern,found);
       }
     }
   }
@@ -7992,6 +8020,61 @@ bool copyFile(const QCString &src,const QCString &dest)
   return TRUE;
 }
 
+/*! Returns the MD5 signature of the contents of file \a fileName
+ *  combined with \a extra.
+ */
+QCString fileSignature(const char *fileName,const QCString &extra)
+{
+  QFile f(fileName);
+  QByteArray data;
+  if (f.open(IO_ReadOnly))
+  {
+    data = f.readAll();
+    f.close();
+  }
+  struct MD5Context ctx;
+  MD5Init(&ctx);
+  MD5Update(&ctx,(const unsigned char *)data.data(),data.size());
+  MD5Update(&ctx,(const unsigned char *)extra.data(),extra.length());
+  uchar md5_sig[16];
+  MD5Final(md5_sig,&ctx);
+  QCString sigStr(33);
+  MD5SigToString(md5_sig,sigStr.rawData(),33);
+  return sigStr;
+}
+
+/*! Checks if a file "baseName".md5 exists. If so the contents
+ *  are compared with \a md5. If equal FALSE is returned. If the .md5
+ *  file does not exist or its contents are not equal to \a md5, 
+ *  a new .md5 is generated with the \a md5 string as contents.
+ */
+bool checkAndUpdateMd5Signature(const QCString &baseName,
+            const QCString &md5)
+{
+  QFile f(baseName+".md5");
+  if (f.open(IO_ReadOnly))
+  {
+    // read checksum
+    QCString md5stored(33);
+    int bytesRead=f.readBlock(md5stored.rawData(),32);
+    md5stored[32]='\0';
+    // compare checksum
+    if (bytesRead==32 && md5==md5stored)
+    {
+      // bail out if equal
+      return FALSE;
+    }
+  }
+  f.close();
+  // create checksum file
+  if (f.open(IO_WriteOnly))
+  {
+    f.writeBlock(md5.data(),32); 
+    f.close();
+  }
+  return TRUE;
+}
+
 /** Returns the section of text, in between a pair of markers. 
  *  Full lines are returned, excluding the lines on which the markers appear.
  */
@@ -8610,3 +8693,13 @@ bool openOutputFile(const char *outFile,QFile &f)
   return fileOpened;
 }
 
+/** Returns the number of threads to use for work that can be done in
+ *  parallel, based on NUM_PROC_THREADS. A value of 0 selects the number
+ *  of processors of the system.
+ */
+int getNumProcThreads()
+{
+  int numThreads = QMIN(32,Config_getInt("NUM_PROC_THREADS"));
+  if (numThreads==0) numThreads = QMAX(1,QThread::idealThreadCount());
+  return numThreads;
+}
@@ -420,6 +420,9 @@ void stackTrace();
 
 bool readInputFile(const char *fileName,BufStr &inBuf,
                    bool filter=TRUE,bool isSourceCode=FALSE);
+bool readRawInputFile(const char *fileName,BufStr &inBuf,const char *filterName,
+                      bool reportErrors=TRUE);
+void convertInputBuffer(const char *fileName,BufStr &inBuf);
 QCString filterTitle(const QCString &title);
 
 bool patternMatch(const QFileInfo &fi,const QStrList *patList);
@@ -444,6 +447,8 @@ void writeColoredImgData(const char *dir,ColoredImgDataItem data[]);
 QCString replaceColorMarkers(const char *str);
 
 bool copyFile(const QCString &src,const QCString &dest);
+QCString fileSignature(const char *fileName,const QCString &extra);
+bool checkAndUpdateMd5Signature(const QCString &baseName,const QCString &md5);
 QCString extractBlock(const QCString text,const QCString marker);
 
 QCString correctURL(const QCString &url,const QCString &relPath);
@@ -476,6 +481,7 @@ void convertProtectionLevel(
 bool mainPageHasTitle();
 void initFilePattern(void);
 bool openOutputFile(const char *outFile,QFile &f);
+int getNumProcThreads();
 
 #endif
 
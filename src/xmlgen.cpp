@@ -34,6 +34,7 @@
 #include "version.h"
 #include "xmldocvisitor.h"
 #include "docparser.h"
+#include "doccache.h"
 #include "language.h"
 #include "parserintf.h"
 #include "arguments.h"
@@ -430,7 +431,7 @@ static void writeXMLDocBlock(FTextStream &t,
   QCString stext = text.stripWhiteSpace();
   if (stext.isEmpty()) return;
   // convert the documentation string into an abstract syntax tree
-  DocNode *root = validatingParseDoc(fileName,lineNr,scope,md,text,FALSE,FALSE);
+  DocRoot *root = DocCache::instance()->parse(fileName,lineNr,scope,md,text,FALSE,FALSE);
   // create a code generator
   XMLCodeGenerator *xmlCodeGen = new XMLCodeGenerator(t);
   // create a parse tree visitor for XML
@@ -440,7 +441,7 @@ static void writeXMLDocBlock(FTextStream &t,
   // clean up
   delete visitor;
   delete xmlCodeGen;
-  delete root;
+  DocCache::instance()->release(root);
   
 }
 
@@ -719,6 +719,43 @@ function setClassAttr(elem,attr)
   elem.setAttribute('className',attr);
 }
 
+// Loads the parts of the search index named baseName_<n>.js for which
+// prefixes[n] can match the search term of the page.
+function loadSearchData(baseName,prefixes)
+{
+  var search = unescape(window.location.search.substring(1));
+  search = search.replace(/^ +/, ""); // strip leading spaces
+  search = search.replace(/ +$/, ""); // strip trailing spaces
+  search = convertToId(search.toLowerCase());
+  for (var i=0; i<prefixes.length; i++)
+  {
+    var prefix = prefixes[i];
+    if (prefix.substr(0, search.length)==search.substr(0, prefix.length))
+    {
+      document.write('<script type="text/javascript" src="'+
+                     baseName+'_'+i.toString(16)+'.js"></'+'script>');
+    }
+  }
+}
+
+// Adds the items of a part of the search index to searchData. The items
+// refer to urls and scopes by their index in the strings array.
+function addSearchData(strings,items)
+{
+  for (var e=0; e<items.length; e++)
+  {
+    var item = items[e][1];
+    for (var c=1; c<item.length; c++)
+    {
+      var child = item[c];
+      var url = strings[child[0]];
+      if (child[1]) url+='#'+child[1];
+      item[c] = [url,child[2],strings[child[3]]];
+    }
+    searchData.push(items[e]);
+  }
+}
+
 function createResults()
 {
   var results = document.getElementById("SRResults");
@@ -48,6 +48,19 @@ function readInt($file)
   return ($b1<<24)|($b2<<16)|($b3<<8)|$b4;
 }
 
+function readVarint($file)
+{
+  $result=0; $shift=0;
+  do
+  {
+    $b = ord(fgetc($file));
+    $result|=($b&0x7f)<<$shift;
+    $shift+=7;
+  }
+  while ($b&0x80);
+  return $result;
+}
+
 function readString($file)
 {
   $result="";
@@ -81,28 +94,36 @@ function search($file,$word,&$statsList)
   $index = computeIndex($word);
   if ($index!=-1) // found a valid index
   {
-    fseek($file,$index*4+4); // 4 bytes per entry, skip header
+    fseek($file,4); // skip header
+    $postingsOffset = readInt($file);
+    $urlTableOffset = readInt($file);
+    $numUrls        = readInt($file);
+    fseek($file,$index*4+16); // 4 bytes per entry
     $index = readInt($file);
     if ($index) // found words matching the hash key
     {
       $start=sizeof($statsList);
       $count=$start;
       fseek($file,$index);
-      $w = readString($file);
-      while ($w)
+      $numWords = readVarint($file);
+      $w = "";
+      for ($n=0;$n<$numWords;$n++)
       {
-        $statIdx = readInt($file);
+        // words are stored as the length of the prefix shared 
+        // with the previous word + the remaining characters
+        $shared = ord(fgetc($file));
+        $w = substr($w,0,$shared).readString($file);
+        $statIdx = readVarint($file);
         if ($word==substr($w,0,strlen($word)))
         { // found word that matches (as substring)
           $statsList[$count++]=array(
               "word"=>$word,
               "match"=>$w,
-              "index"=>$statIdx,
+              "index"=>$postingsOffset+$statIdx,
               "full"=>strlen($w)==strlen($word),
               "docs"=>array()
               );
         }
-        $w = readString($file);
       }
       $totalHi=0;
       $totalFreqHi=0;
@@ -114,13 +135,14 @@ function search($file,$word,&$statsList)
         // whole word matches have a double weight
         if ($statInfo["full"]) $multiplier=2;
         fseek($file,$statInfo["index"]); 
-        $numDocs = readInt($file);
+        $numDocs = readVarint($file);
         $docInfo = array();
         // read docs info + occurrence frequency of the word
+        $idx=0;
         for ($i=0;$i<$numDocs;$i++)
         {
-          $idx=readInt($file); 
-          $freq=readInt($file); 
+          $idx+=readVarint($file); 
+          $freq=readVarint($file); 
           $docInfo[$i]=array("idx"  => $idx,
                              "freq" => $freq>>1,
                              "rank" => 0.0,
@@ -139,7 +161,9 @@ function search($file,$word,&$statsList)
         // read name and url info for the doc
         for ($i=0;$i<$numDocs;$i++)
         {
-          fseek($file,$docInfo[$i]["idx"]);
+          fseek($file,$urlTableOffset+$docInfo[$i]["idx"]*4);
+          $urlOffset = readInt($file);
+          fseek($file,$urlTableOffset+$numUrls*4+$urlOffset);
           $docInfo[$i]["name"]=readString($file);
           $docInfo[$i]["url"]=readString($file);
         }
@@ -316,7 +340,7 @@ function run_query($query)
   {
     die("Error: Search index file could NOT be opened!");
   }
-  if (readHeader($file)!="DOXS")
+  if (readHeader($file)!="DOX2")
   {
     die("Error: Header of index file is invalid!");
   }